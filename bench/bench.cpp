@@ -0,0 +1,117 @@
+// benchmarks for the Graph search engines on a synthetic campus.
+// run from the build directory: ./Bench [grid side] [queries]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "Graph.h"
+#include "SearchWorkspace.h"
+
+using namespace std;
+
+// a side x side grid of walkways with a few long shortcuts, ids 0..side*side-1
+static void buildCampus(Graph& g, int side, mt19937& rng) {
+    for (int r = 0; r < side; r++) {
+        for (int c = 0; c < side; c++) {
+            int id = r * side + c;
+            if (c + 1 < side) g.addEdge(id, id + 1, 1 + rng() % 10);
+            if (r + 1 < side) g.addEdge(id, id + side, 1 + rng() % 10);
+        }
+    }
+    for (int i = 0; i < side; i++) {
+        g.addEdge(rng() % (side * side), rng() % (side * side), 10 + rng() % 30);
+    }
+}
+
+static void runQueries(const char* name, const Graph& g, const vector<pair<int,int>>& queries) {
+    size_t settledBefore = SearchWorkspace::settledCount();
+    long long checksum = 0;
+    auto start = chrono::steady_clock::now();
+    for (auto [s, t] : queries) checksum += g.shortestPath(s, t);
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    double settled = double(SearchWorkspace::settledCount() - settledBefore) / queries.size();
+    printf("%-22s %10.3f ms  %10.1f settled/query  checksum %lld\n", name, ms, settled, checksum);
+}
+
+// prim over random blocks of a third of the campus side, which are connected
+static void runSpanningTrees(const char* name, const Graph& g, const vector<vector<int>>& subsets) {
+    long long checksum = 0;
+    auto start = chrono::steady_clock::now();
+    for (const auto& subset : subsets) checksum += g.mstCost(subset);
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    printf("%-22s %10.3f ms  %10zu subsets       checksum %lld\n", name, ms, subsets.size(), checksum);
+}
+
+int main(int argc, char** argv) {
+    int side = argc > 1 ? atoi(argv[1]) : 100;
+    int count = argc > 2 ? atoi(argv[2]) : 500;
+    mt19937 rng(42);
+
+    Graph g;
+    buildCampus(g, side, rng);
+    vector<pair<int,int>> queries;
+    for (int i = 0; i < count; i++) {
+        queries.push_back({(int)(rng() % (side * side)), (int)(rng() % (side * side))});
+    }
+    printf("%d locations, %d point-to-point queries\n", side * side, count);
+
+    g.setPathSearch(PathSearch::Dijkstra);
+    g.setBucketQueueLimit(0);
+    runQueries("dijkstra (heap)", g, queries);
+    g.setBucketQueueLimit(255);
+    runQueries("dijkstra (buckets)", g, queries);
+
+    vector<vector<int>> subsets(50);
+    int block = max(1, side / 3);
+    for (auto& subset : subsets) {
+        int r0 = rng() % (side - block + 1);
+        int c0 = rng() % (side - block + 1);
+        for (int r = r0; r < r0 + block; r++) {
+            for (int c = c0; c < c0 + block; c++) subset.push_back(r * side + c);
+        }
+    }
+    g.setBucketQueueLimit(0);
+    runSpanningTrees("prim (heap)", g, subsets);
+    g.setBucketQueueLimit(255);
+    runSpanningTrees("prim (buckets)", g, subsets);
+
+    // bands of half the campus are well past the kruskal threshold
+    vector<vector<int>> large(10);
+    for (auto& subset : large) {
+        int r0 = rng() % (side - side / 2 + 1);
+        for (int v = r0 * side; v < (r0 + side / 2) * side; v++) subset.push_back(v);
+    }
+    runSpanningTrees("kruskal (large sets)", g, large);
+
+    g.setPathSearch(PathSearch::Bidirectional);
+    runQueries("bidirectional", g, queries);
+
+    g.setPathSearch(PathSearch::Landmarks);
+    g.shortestPath(0, 0);  // builds the landmark tables outside the timing
+    runQueries("a* landmarks (8)", g, queries);
+
+    g.setPathSearch(PathSearch::ContractionHierarchy);
+    auto start = chrono::steady_clock::now();
+    g.shortestPath(0, 0);  // orders and customizes the hierarchy
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    printf("%-22s %10.3f ms\n", "hierarchy preprocess", ms);
+    runQueries("contraction hierarchy", g, queries);
+
+    // a toggle keeps the ordering and redoes only the shortcuts above the
+    // edge. each edge is toggled twice, so the campus ends as it began
+    vector<pair<int,int>> walkways;
+    for (int i = 0; i < side; i++) {
+        int id = (rng() % side) * side + rng() % max(1, side - 1);
+        walkways.push_back({id, id + 1});
+    }
+    start = chrono::steady_clock::now();
+    for (int pass = 0; pass < 2; pass++) {
+        for (auto [a, b] : walkways) g.toggleEdge(a, b);
+    }
+    ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    printf("%-22s %10.3f ms  %10zu toggles\n", "hierarchy toggles", ms, 2 * walkways.size());
+    runQueries("hierarchy after toggles", g, queries);
+    return 0;
+}
@@ -1,261 +1,521 @@
-#include <fstream>
-#include <sstream>
 #include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <cstdio>
+#include <algorithm>
 #include "CampusCompass.h"
+#include "CommandTokens.h"
+#include "CsvRows.h"
+#include "MappedFile.h"
+#include "Snapshot.h"
 
 using namespace std;
 
-CampusCompass::CampusCompass() {
-    // initialize your object
+// all-pairs distances are cached while the distance and parent matrices
+// together fit in this much memory (about 2900 locations)
+static const size_t DISTANCE_CACHE_BUDGET = 64u << 20;
+
+namespace {
+    enum class Verb {
+        Unknown, Insert, Remove, DropClass, ReplaceClass, RemoveClass, ToggleEdgesClosure,
+        CheckEdgeStatus, IsConnected, PrintShortestEdges, PrintStudentZone, VerifySchedule,
+    };
+
+    // length and first letter leave at most one candidate verb, so a
+    // command costs one full comparison
+    Verb verbOf(string_view word) {
+        Verb verb = Verb::Unknown;
+        string_view name;
+        char first = word.empty() ? 0 : word[0];
+        switch (word.size()) {
+            case 6:
+                if (first == 'i') { verb = Verb::Insert; name = "insert"; }
+                else if (first == 'r') { verb = Verb::Remove; name = "remove"; }
+                break;
+            case 9:
+                if (first == 'd') { verb = Verb::DropClass; name = "dropClass"; }
+                break;
+            case 11:
+                if (first == 'r') { verb = Verb::RemoveClass; name = "removeClass"; }
+                else if (first == 'i') { verb = Verb::IsConnected; name = "isConnected"; }
+                break;
+            case 12:
+                if (first == 'r') { verb = Verb::ReplaceClass; name = "replaceClass"; }
+                break;
+            case 14:
+                if (first == 'v') { verb = Verb::VerifySchedule; name = "verifySchedule"; }
+                break;
+            case 15:
+                if (first == 'c') { verb = Verb::CheckEdgeStatus; name = "checkEdgeStatus"; }
+                break;
+            case 16:
+                if (first == 'p') { verb = Verb::PrintStudentZone; name = "printStudentZone"; }
+                break;
+            case 18:
+                if (first == 't') { verb = Verb::ToggleEdgesClosure; name = "toggleEdgesClosure"; }
+                else if (first == 'p') { verb = Verb::PrintShortestEdges; name = "printShortestEdges"; }
+                break;
+        }
+        return word == name ? verb : Verb::Unknown;
+    }
+}
+
+CampusCompass::CampusCompass(ostream &out) : output(out) {
+    campusGraph.setDistanceCacheBudget(DISTANCE_CACHE_BUDGET);
+}
+
+void CampusCompass::flushOutput() {
+    output.flush();
+}
+
+int CampusCompass::zoneCost(const vector<int> &vertices) {
+    zoneScratch.assign(vertices.begin(), vertices.end());
+    sort(zoneScratch.begin(), zoneScratch.end());
+    uint64_t key = 1469598103934665603ull;  // fnv-1a over the sorted ids
+    for (int v : zoneScratch) {
+        key ^= (uint32_t)v;
+        key *= 1099511628211ull;
+    }
+
+    auto it = zoneCosts.find(key);
+    if (it != zoneCosts.end()) {
+        if (it->second.vertices == zoneScratch && zoneStillValid(it->second)) {
+            zoneHits++;
+            return it->second.cost;
+        }
+        zoneCosts.erase(it);  // stale, or another set with the same fingerprint
+    }
+    zoneMisses++;
+    int cost = campusGraph.mstCost(vertices);
+    if (zoneCosts.size() >= zoneCapacity) evictZones();
+    zoneCosts.emplace(key, ZoneCost{zoneScratch, cost, campusGraph.version()});
+    return cost;
+}
+
+void CampusCompass::evictZones() {
+    // stale entries go first; if that frees less than half the memo the
+    // rest go too, so a full memo costs one sweep per capacity / 2 misses
+    for (auto it = zoneCosts.begin(); it != zoneCosts.end();) {
+        if (zoneStillValid(it->second)) ++it;
+        else it = zoneCosts.erase(it);
+    }
+    if (zoneCosts.size() > zoneCapacity / 2) zoneCosts.clear();
+}
+
+bool CampusCompass::zoneStillValid(ZoneCost &zone) {
+    // the spanning tree only uses edges inside the set
+    if (zone.version == campusGraph.version()) return true;
+    if (!campusGraph.toggledSince(zone.version, toggled)) return false;
+    for (auto [a, b] : toggled) {
+        if (binary_search(zone.vertices.begin(), zone.vertices.end(), a) &&
+            binary_search(zone.vertices.begin(), zone.vertices.end(), b)) return false;
+    }
+    zone.version = campusGraph.version();
+    return true;
+}
+
+int CampusCompass::travelTime(int from, int to) {
+    // a toggle anywhere can reroute any pair, so the memo only lives for
+    // one graph version
+    if (travelVersion != campusGraph.version()) {
+        travelTimes.clear();
+        travelVersion = campusGraph.version();
+    }
+    // edges are undirected, so both directions share an entry
+    uint64_t key = ((uint64_t)(uint32_t)min(from, to) << 32) | (uint32_t)max(from, to);
+    auto it = travelTimes.find(key);
+    if (it != travelTimes.end()) {
+        travelHits++;
+        return it->second;
+    }
+    travelMisses++;
+    int time = campusGraph.shortestPath(from, to);
+    travelTimes.emplace(key, time);
+    return time;
 }
 
 bool CampusCompass::ParseCSV(const string &edges_filepath, const string &classes_filepath) {
-    std::ifstream edges_file(edges_filepath);
-    if(!edges_file.is_open()) {
-        return false; // failed to open edges file
+    // both files are mapped and scanned in place into rows first, so a
+    // missing file or malformed row leaves the campus as it was; the rows
+    // counted up front size the tables before anything is inserted
+    MappedFile edges_file;
+    MappedFile classes_file;
+    if (!edges_file.open(edges_filepath) || !classes_file.open(classes_filepath)) {
+        return false; // failed to open a file
+    }
+
+    struct EdgeRow {
+        int id1;
+        int id2;
+        string_view name1;
+        string_view name2;
+        int time;
+    };
+    vector<EdgeRow> edgeRows;
+    edgeRows.reserve(CsvRows::countLines(edges_file.view()));
+    CsvRows edges(edges_file.view());
+    edges.nextRow(); // skip header
+
+    while (edges.nextRow()) {
+        EdgeRow row;
+        row.id1 = edges.integer();
+        row.id2 = edges.integer();
+        row.name1 = edges.field();
+        row.name2 = edges.field();
+        row.time = edges.integer();
+        if (edges.failed()) {
+            return false; // malformed row
+        }
+        edgeRows.push_back(row);
     }
 
-    string line;
-    getline(edges_file, line); // skip header
+    struct ClassRow {
+        string_view code;
+        ClassInfo info;
+    };
+    vector<ClassRow> classRows;
+    classRows.reserve(CsvRows::countLines(classes_file.view()));
+    CsvRows classes(classes_file.view());
+    classes.nextRow(); // skip header
 
-    while(getline(edges_file, line)) {
-        string locId1;
-        string locId2;
-        string name1;
-        string name2;
-        string time;
-        stringstream ss(line);
+    while (classes.nextRow()) {
+        ClassRow row;
+        row.code = classes.field();
+        row.info.locationId = classes.integer();
+        row.info.startMinutes = classes.minutes();
+        row.info.endMinutes = classes.minutes();
+        if (classes.failed()) {
+            return false;
+        }
+        classRows.push_back(row);
+    }
+
+    // add locations and edges
+    campusGraph.reserve(2 * edgeRows.size(), edgeRows.size());
+    for (const auto &row : edgeRows) {
+        campusGraph.addLocation(row.id1, row.name1);
+        campusGraph.addLocation(row.id2, row.name2);
+        campusGraph.addEdge(row.id1, row.id2, row.time);
+    }
+
+    studentManager.reserveClasses(classRows.size());
+    for (const auto &row : classRows) {
+        studentManager.addClassInfo(string(row.code), row.info.locationId, row.info.startMinutes, row.info.endMinutes);
+    }
+
+    // every student query ends at a class, so keep a column per class location
+    campusGraph.setDistanceTableSources(studentManager.getClassLocations());
+    return true;
+}
 
-        getline(ss, locId1, ',');   
-        getline(ss, locId2, ',');
-        getline(ss, name1, ',');
-        getline(ss, name2, ',');
-        getline(ss, time, ',');
+namespace {
+    // "CCSNAPSH" read as a little-endian integer; on a machine with the
+    // other byte order it does not match
+    const uint64_t SNAPSHOT_MAGIC = 0x485350414e534343ull;
+    // bumped whenever the layout changes
+    const uint32_t SNAPSHOT_FORMAT = 1;
 
-        int id1 = stoi(locId1);
-        int id2 = stoi(locId2);
-        int travel_time = stoi(time);
+    // what a snapshot remembers about a source file to tell it has changed
+    struct FileStamp {
+        uint64_t size = 0;
+        uint64_t modified = 0;
+    };
 
-        // add locations and edge
-        campusGraph.addLocation(id1, name1);
-        campusGraph.addLocation(id2, name2);
-        campusGraph.addEdge(id1, id2, travel_time);
+    bool stampOf(const string &path, FileStamp &stamp) {
+        error_code ec;
+        stamp.size = filesystem::file_size(path, ec);
+        if (ec) return false;
+        auto modified = filesystem::last_write_time(path, ec);
+        if (ec) return false;
+        stamp.modified = (uint64_t)modified.time_since_epoch().count();
+        return true;
     }
+}
 
-    // parse classes file
-    std::ifstream classes_file(classes_filepath);
-    if(!classes_file.is_open()) {
+bool CampusCompass::SaveSnapshot(const string &snapshot_filepath, const string &edges_filepath, const string &classes_filepath) {
+    FileStamp edgesStamp;
+    FileStamp classesStamp;
+    if (!stampOf(edges_filepath, edgesStamp) || !stampOf(classes_filepath, classesStamp)) {
         return false;
     }
 
-    getline(classes_file, line); // skip header
+    // class catalog first, by code so the same campus gives the same bytes
+    SnapshotWriter payload;
+    const auto &catalog = studentManager.getClassCatalog();
+    vector<const string*> codes;
+    codes.reserve(catalog.size());
+    for (const auto &[code, info] : catalog) codes.push_back(&code);
+    sort(codes.begin(), codes.end(), [](const string *a, const string *b) { return *a < *b; });
+    payload.put<uint64_t>(codes.size());
+    for (const string *code : codes) {
+        const ClassInfo &info = catalog.at(*code);
+        payload.putString(*code);
+        payload.put<int>(info.locationId);
+        payload.put<int>(info.startMinutes);
+        payload.put<int>(info.endMinutes);
+    }
+    campusGraph.writeSnapshot(payload, true);
 
-    while(getline(classes_file, line)) {
-        string classCode;
-        string locIdStr;
-        string startTimeStr;
-        string endTimeStr;
-        stringstream ss(line);
+    SnapshotWriter header;
+    header.put<uint64_t>(SNAPSHOT_MAGIC);
+    header.put<uint32_t>(SNAPSHOT_FORMAT);
+    header.put<uint64_t>(edgesStamp.size);
+    header.put<uint64_t>(edgesStamp.modified);
+    header.put<uint64_t>(classesStamp.size);
+    header.put<uint64_t>(classesStamp.modified);
+    header.put<uint64_t>(payload.data().size());
+    header.put<uint64_t>(snapshotChecksum(payload.data()));
 
-        getline(ss, classCode, ',');
-        getline(ss, locIdStr, ',');
-        getline(ss, startTimeStr, ',');
-        getline(ss, endTimeStr, ',');
+    // written aside and renamed into place, so a reader never sees half a file
+    string partial = snapshot_filepath + ".tmp";
+    {
+        ofstream file(partial, ios::binary | ios::trunc);
+        if (!file.is_open()) return false;
+        file.write(header.data().data(), header.data().size());
+        file.write(payload.data().data(), payload.data().size());
+        if (!file.flush()) {
+            file.close();
+            std::remove(partial.c_str());
+            return false;
+        }
+    }
+    if (std::rename(partial.c_str(), snapshot_filepath.c_str()) != 0) {
+        std::remove(partial.c_str());
+        return false;
+    }
+    return true;
+}
 
-        int locationId = stoi(locIdStr);
-    
-        // parse time to minutes
-        int startHour = stoi(startTimeStr.substr(0, 2));
-        int startMin = stoi(startTimeStr.substr(3, 2));
-        int startMinutes = startHour * 60 + startMin;
-        
-        int endHour = stoi(endTimeStr.substr(0, 2));
-        int endMin = stoi(endTimeStr.substr(3, 2));
-        int endMinutes = endHour * 60 + endMin;
+bool CampusCompass::LoadSnapshot(const string &snapshot_filepath, const string &edges_filepath, const string &classes_filepath) {
+    MappedFile file;
+    if (!file.open(snapshot_filepath)) {
+        return false;
+    }
 
-        studentManager.addClassInfo(classCode, locationId, startMinutes, endMinutes);
+    SnapshotReader in(file.view());
+    if (in.get<uint64_t>() != SNAPSHOT_MAGIC || in.get<uint32_t>() != SNAPSHOT_FORMAT) {
+        return false;
+    }
+    FileStamp edgesStamp;
+    FileStamp classesStamp;
+    if (!stampOf(edges_filepath, edgesStamp) || !stampOf(classes_filepath, classesStamp)) {
+        return false;
+    }
+    if (in.get<uint64_t>() != edgesStamp.size || in.get<uint64_t>() != edgesStamp.modified
+        || in.get<uint64_t>() != classesStamp.size || in.get<uint64_t>() != classesStamp.modified) {
+        return false; // stale
+    }
+    uint64_t payloadSize = in.get<uint64_t>();
+    uint64_t checksum = in.get<uint64_t>();
+    if (in.failed() || payloadSize != in.remaining() || checksum != snapshotChecksum(in.unread())) {
+        return false;
     }
 
+    // the catalog is only added once the graph has been accepted
+    uint64_t classCount = in.get<uint64_t>();
+    vector<pair<string_view, ClassInfo>> classes;
+    for (uint64_t i = 0; i < classCount && !in.failed(); i++) {
+        string_view code = in.getString();
+        int locationId = in.get<int>();
+        int startMinutes = in.get<int>();
+        int endMinutes = in.get<int>();
+        classes.push_back({code, {locationId, startMinutes, endMinutes}});
+    }
+    if (in.failed() || !campusGraph.readSnapshot(in)) {
+        return false;
+    }
+
+    studentManager.reserveClasses(classes.size());
+    for (const auto &[code, info] : classes) {
+        studentManager.addClassInfo(string(code), info.locationId, info.startMinutes, info.endMinutes);
+    }
+    return true;
+}
+
+bool CampusCompass::LoadCampus(const string &edges_filepath, const string &classes_filepath, const string &snapshot_filepath) {
+    if (LoadSnapshot(snapshot_filepath, edges_filepath, classes_filepath)) {
+        return true;
+    }
+    if (!ParseCSV(edges_filepath, classes_filepath)) {
+        return false;
+    }
+    SaveSnapshot(snapshot_filepath, edges_filepath, classes_filepath); // best effort
     return true;
 }
 
-bool CampusCompass::ParseCommand(const string &command) {
-    stringstream ss(command);
-    string cmd;
-    ss >> cmd;
+bool CampusCompass::ParseCommand(string_view command) {
+    CommandTokens in(command);
+    Verb verb = verbOf(in.word());
     
-    if (cmd == "insert") {
-        string name;
-        string id;
-        int residence;
-        int n;
-        
+    if (verb == Verb::Insert) {
         // extract  name
-        string temp;
-        getline(ss, temp, '"'); // skip to first quote
-        getline(ss, name, '"'); // get name between quotes
-        
-        ss >> id >> residence >> n;
+        string name(in.quoted()); // between the first pair of quotes
+        string id(in.word());
+        int residence = in.number();
+        int n = in.number();
         
         // validate residence exists
         if (!campusGraph.hasLocation(residence)) {
-            cout << "unsuccessful" << endl;
+            output << "unsuccessful" << '\n';
             return false;
         }
         
+        // a missing code fails the count check below, so stop at the first
         vector<string> classes;
-        for (int i = 0; i < n; i++) {
-            string classCode;
-            ss >> classCode;
-            classes.push_back(classCode);
+        for (int i = 0; i < n && !in.failed(); i++) {
+            string_view classCode = in.word();
+            if (!in.failed()) classes.emplace_back(classCode);
         }
         
         if (classes.size() != (size_t)n) {
-            cout << "unsuccessful" << endl;
+            output << "unsuccessful" << '\n';
             return false;
         }
         
         bool success = studentManager.insertStudent(name, id, residence, classes);
-        cout << (success ? "successful" : "unsuccessful") << endl;
+        output << (success ? "successful" : "unsuccessful") << '\n';
         return success;
     }
-    else if (cmd == "remove") {
+    else if (verb == Verb::Remove) {
         // remove STUDENT_ID
-        string id;
-        ss >> id;
+        string id(in.word());
         
         bool success = studentManager.removeStudent(id);
-        cout << (success ? "successful" : "unsuccessful") << endl;
+        output << (success ? "successful" : "unsuccessful") << '\n';
         return success;
     }
-    else if (cmd == "dropClass") {
+    else if (verb == Verb::DropClass) {
         // dropClass STUDENT_ID CLASSCODE
-        string id, classCode;
-        ss >> id >> classCode;
+        string id(in.word());
+        string classCode(in.word());
         
         if (!studentManager.classExists(classCode)) {
-            cout << "unsuccessful" << endl;
+            output << "unsuccessful" << '\n';
             return false;
         }
         
         bool success = studentManager.dropClass(id, classCode);
-        cout << (success ? "successful" : "unsuccessful") << endl;
+        output << (success ? "successful" : "unsuccessful") << '\n';
         return success;
     }
-    else if (cmd == "replaceClass") {
+    else if (verb == Verb::ReplaceClass) {
         // replaceClass STUDENT_ID CLASSCODE_1 CLASSCODE_2
-        string id, classFrom, classTo;
-        ss >> id >> classFrom >> classTo;
+        string id(in.word());
+        string classFrom(in.word());
+        string classTo(in.word());
         
         bool success = studentManager.replaceClass(id, classFrom, classTo);
-        cout << (success ? "successful" : "unsuccessful") << endl;
+        output << (success ? "successful" : "unsuccessful") << '\n';
         return success;
     }
-    else if (cmd == "removeClass") {
+    else if (verb == Verb::RemoveClass) {
         // removeClass CLASSCODE
-        string classCode;
-        ss >> classCode;
+        string classCode(in.word());
         
         int count = studentManager.removeClassFromAll(classCode);
-        cout << count << endl;
+        output << count << '\n';
         return true;
     }
-    else if (cmd == "toggleEdgesClosure") {
+    else if (verb == Verb::ToggleEdgesClosure) {
         // toggleEdgesClosure N LOCATION_ID_X LOCATION_ID_Y ...
-        int n;
-        ss >> n;
+        int n = in.number();
         
-        for (int i = 0; i < n; i++) {
-            int locX, locY;
-            ss >> locX >> locY;
-            campusGraph.toggleEdge(locX, locY);
+        // pairs past the end of the line would all read as 0 0
+        vector<pair<int, int>> pairs;
+        for (int i = 0; i < n && !in.failed(); i++) {
+            int locX = in.number();
+            int locY = in.number();
+            pairs.push_back({locX, locY});
         }
+        campusGraph.toggleEdges(pairs);
         
-        cout << "successful" << endl;
+        output << "successful" << '\n';
         return true;
     }
-    else if (cmd == "checkEdgeStatus") {
+    else if (verb == Verb::CheckEdgeStatus) {
         // checkEdgeStatus LOCATION_ID_X LOCATION_ID_Y
-        int locX, locY;
-        ss >> locX >> locY;
+        int locX = in.number();
+        int locY = in.number();
         
-        cout << campusGraph.edgeStatus(locX, locY) << endl;
+        output << campusGraph.edgeStatus(locX, locY) << '\n';
         return true;
     }
-    else if (cmd == "isConnected") {
+    else if (verb == Verb::IsConnected) {
         // isConnected LOCATION_ID_1 LOCATION_ID_2
-        int loc1, loc2;
-        ss >> loc1 >> loc2;
+        int loc1 = in.number();
+        int loc2 = in.number();
         
         bool connected = campusGraph.isConnected(loc1, loc2);
-        cout << (connected ? "successful" : "unsuccessful") << endl;
+        output << (connected ? "successful" : "unsuccessful") << '\n';
         return connected;
     }
-    else if (cmd == "printShortestEdges") {
+    else if (verb == Verb::PrintShortestEdges) {
         // printShortestEdges ID
-        string id;
-        ss >> id;
+        string id(in.word());
         
         const Student* student = studentManager.getStudent(id);
         if (!student) {
-            cout << "unsuccessful" << endl;
+            output << "unsuccessful" << '\n';
             return false;
         }
         
-        cout << "Name: " << student->name << endl;
+        output << "Name: " << student->name << '\n';
         
         vector<string> sortedClasses = studentManager.getSortedClasses(id);
+        vector<string> listed;
+        vector<int> classLocations;
         for (const auto& classCode : sortedClasses) {
             const ClassInfo* classInfo = studentManager.getClassInfo(classCode);
             if (classInfo) {
-                int distance = campusGraph.shortestPath(student->residenceLocationId, classInfo->locationId);
-                cout << classCode << " | Total Time: " << distance << endl;
+                listed.push_back(classCode);
+                classLocations.push_back(classInfo->locationId);
             }
         }
+
+        // class locations have distance columns, so these are lookups
+        vector<int> distances;
+        campusGraph.shortestPaths(student->residenceLocationId, classLocations, distances);
+        for (size_t i = 0; i < listed.size(); i++) {
+            output << listed[i] << " | Total Time: " << distances[i] << '\n';
+        }
         
         return true;
     }
-    else if (cmd == "printStudentZone") {
+    else if (verb == Verb::PrintStudentZone) {
         // printStudentZone ID
-        string id;
-        ss >> id;
+        string id(in.word());
         
         const Student* student = studentManager.getStudent(id);
         if (!student) {
-            cout << "unsuccessful" << endl;
+            output << "unsuccessful" << '\n';
             return false;
         }
         
-        // Collect all vertices from shortest paths to all classes
-        unordered_set<int> vertices;
+        // the zone spans every location on the shortest routes to the classes
+        vector<int> classLocations;
         vector<string> sortedClasses = studentManager.getSortedClasses(id);
-        
         for (const auto& classCode : sortedClasses) {
             const ClassInfo* classInfo = studentManager.getClassInfo(classCode);
             if (classInfo) {
-                vector<int> route;
-                int distance = campusGraph.shortestPathWithRoute(student->residenceLocationId, classInfo->locationId, route);
-                
-                if (distance >= 0) {
-                    for (int vertex : route) {
-                        vertices.insert(vertex);
-                    }
-                }
+                classLocations.push_back(classInfo->locationId);
             }
         }
-        
-        int cost = campusGraph.mstCost(vertices);
-        cout << "Student Zone Cost For " << student->name << ": " << cost << endl;
+
+        ShortestPathTree routes;
+        campusGraph.shortestPathTree(student->residenceLocationId, classLocations, routes);
+        const vector<int>& vertices = routes.vertices();
+
+        int cost = zoneCost(vertices);
+        output << "Student Zone Cost For " << student->name << ": " << cost << '\n';
         return true;
     }
-    else if (cmd == "verifySchedule") {
+    else if (verb == Verb::VerifySchedule) {
         // verifySchedule ID
-        string id;
-        ss >> id;
+        string id(in.word());
         
         const Student* student = studentManager.getStudent(id);
         if (!student) {
-            cout << "unsuccessful" << endl;
+            output << "unsuccessful" << '\n';
             return false;
         }
         
@@ -269,14 +529,14 @@ bool CampusCompass::ParseCommand(const string &command) {
         }
         
         if (classSchedule.size() < 2) {
-            cout << "unsuccessful" << endl;
+            output << "unsuccessful" << '\n';
             return false;
         }
         
         // Sort by start time
         sort(classSchedule.begin(), classSchedule.end());
         
-        cout << "Schedule Check for " << student->name << ":" << endl;
+        output << "Schedule Check for " << student->name << ":" << '\n';
         
         for (size_t i = 0; i + 1 < classSchedule.size(); i++) {
             const string& class1 = classSchedule[i].second;
@@ -287,16 +547,16 @@ bool CampusCompass::ParseCommand(const string &command) {
             
             if (info1 && info2) {
                 int timeGap = info2->startMinutes - info1->endMinutes;
-                int travelTime = campusGraph.shortestPath(info1->locationId, info2->locationId);
+                int travel = travelTime(info1->locationId, info2->locationId);
                 
-                bool canMakeIt = (travelTime >= 0 && timeGap >= travelTime);
-                cout << class1 << " - " << class2 << " \"" << (canMakeIt ? "Can make it!" : "Cannot make it!") << "\"" << endl;
+                bool canMakeIt = (travel >= 0 && timeGap >= travel);
+                output << class1 << " - " << class2 << " \"" << (canMakeIt ? "Can make it!" : "Cannot make it!") << "\"" << '\n';
             }
         }
         
         return true;
     }
     
-    cout << "unsuccessful" << endl;
+    output << "unsuccessful" << '\n';
     return false;
 }
@@ -1,7 +1,13 @@
 #pragma once
 #include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <iostream>
 #include "Graph.h"
 #include "StudentManager.h"
+#include "OutputSink.h"
 
 using namespace std;
 
@@ -11,9 +17,65 @@ private:
     // perhaps some graph representation?
     Graph campusGraph;
     StudentManager studentManager;
+    // every command writes its results here
+    OutputSink output;
+
+    // zone costs by location set. students sharing a residence and course
+    // load span the same set, so most zones repeat. a cost stays valid
+    // until an edge with both ends in its set is toggled
+    struct ZoneCost {
+        vector<int> vertices;  // sorted, to tell fingerprint collisions apart
+        int cost;
+        uint64_t version;      // graph version the cost was last known at
+    };
+    unordered_map<uint64_t, ZoneCost> zoneCosts;
+    // most entries kept; see evictZones
+    size_t zoneCapacity = 4096;
+    size_t zoneHits = 0;
+    size_t zoneMisses = 0;
+    vector<int> zoneScratch;
+    vector<pair<int,int>> toggled;
+
+    // travel times between consecutive classes, by unordered location pair.
+    // the same few class pairs repeat across every student's schedule
+    unordered_map<uint64_t, int> travelTimes;
+    size_t travelHits = 0;
+    size_t travelMisses = 0;
+
+    // graph version the travel times were filled at; any change empties them
+    uint64_t travelVersion = 0;
+
+    int zoneCost(const vector<int>& vertices);
+    bool zoneStillValid(ZoneCost& zone);
+    void evictZones();
+    int travelTime(int from, int to);
 public:
     // Think about what helper functions you will need in the algorithm
-    CampusCompass(); // constructor
+    // results go to out, buffered; they reach it on flushOutput(), when
+    // enough has piled up, and when the CampusCompass is destroyed
+    explicit CampusCompass(ostream &out = cout); // constructor
     bool ParseCSV(const string &edges_filepath, const string &classes_filepath);
-    bool ParseCommand(const string &command);
+    // writes the loaded campus (graph, names, class catalog and the class
+    // location distance columns) to a binary snapshot, stamped with the
+    // size and modification time of the two csv files it was loaded from
+    bool SaveSnapshot(const string &snapshot_filepath, const string &edges_filepath, const string &classes_filepath);
+    // loads a snapshot into a CampusCompass with nothing loaded yet. false,
+    // leaving it empty, if the file is missing or damaged, has another
+    // format version, or either csv file has changed since it was written
+    bool LoadSnapshot(const string &snapshot_filepath, const string &edges_filepath, const string &classes_filepath);
+    // the snapshot when it is current, otherwise the csv files, saving a
+    // fresh snapshot for next time
+    bool LoadCampus(const string &edges_filepath, const string &classes_filepath, const string &snapshot_filepath);
+    bool ParseCommand(string_view command);
+    void flushOutput();
+
+    // how often printStudentZone found its cost memoized
+    size_t zoneCacheHits() const { return zoneHits; }
+    size_t zoneCacheMisses() const { return zoneMisses; }
+    // zone costs memoized now, and the most that will be kept
+    size_t zoneCacheSize() const { return zoneCosts.size(); }
+    void setZoneCacheCapacity(size_t entries) { zoneCapacity = entries; }
+    // how often verifySchedule found a travel time memoized
+    size_t travelCacheHits() const { return travelHits; }
+    size_t travelCacheMisses() const { return travelMisses; }
 };
@@ -0,0 +1,65 @@
+#include "CommandBatch.h"
+#include "MappedFile.h"
+#include <cstring>
+#include <vector>
+
+using namespace std;
+
+void CommandBatch::line(string_view text) {
+    if (!started) {
+        started = true;
+        // the count line: digits, maybe padded, and nothing else
+        size_t first = text.find_first_not_of(" \t\r");
+        size_t last = text.find_last_not_of(" \t\r");
+        if (first != string_view::npos) {
+            string_view field = text.substr(first, last - first + 1);
+            if (field.find_first_not_of("0123456789") == string_view::npos) {
+                limit = field.size() < 19 ? stoull(string(field)) : (size_t)-1;
+                return;
+            }
+        }
+    }
+    if (done()) return;
+    compass.ParseCommand(text);
+    count++;
+}
+
+size_t CommandBatch::feed(string_view text, bool last) {
+    size_t used = 0;
+    while (used < text.size() && !done()) {
+        const void *end = memchr(text.data() + used, '\n', text.size() - used);
+        if (!end) break;
+        size_t stop = static_cast<const char *>(end) - text.data();
+        line(text.substr(used, stop - used));
+        used = stop + 1;
+    }
+    if (last && used < text.size() && !done()) {
+        line(text.substr(used));
+        used = text.size();
+    }
+    return used;
+}
+
+bool CommandBatch::runFile(const std::string &path) {
+    MappedFile file;
+    if (!file.open(path)) return false;
+    feed(file.view(), true);
+    return true;
+}
+
+void CommandBatch::runStream(FILE *in) {
+    // lines are run where they sit in the buffer; a partial line at the end
+    // of a chunk moves to the front and the next read appends to it
+    vector<char> buffer(1 << 20);
+    size_t held = 0;
+    while (!done()) {
+        if (held == buffer.size()) buffer.resize(buffer.size() * 2);  // a very long line
+        size_t got = fread(buffer.data() + held, 1, buffer.size() - held, in);
+        held += got;
+        bool last = got == 0;
+        size_t used = feed(string_view(buffer.data(), held), last);
+        if (last) break;
+        memmove(buffer.data(), buffer.data() + used, held - used);
+        held -= used;
+    }
+}
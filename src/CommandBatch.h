@@ -0,0 +1,36 @@
+#pragma once
+#include <cstdio>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include "CampusCompass.h"
+
+// replays a command log through a CampusCompass, one line per command,
+// handing ParseCommand views straight into the buffer that holds the log.
+// a first line holding nothing but a number is the command count of the
+// interactive format, and no more than that many commands run
+class CommandBatch {
+private:
+    CampusCompass& compass;
+    bool started = false;
+    size_t limit = (size_t)-1;
+    size_t count = 0;
+
+    void line(std::string_view text);
+
+public:
+    explicit CommandBatch(CampusCompass& compass) : compass(compass) {}
+
+    // runs every complete line of text and returns how many bytes that
+    // used; the unfinished tail is left for the next call. with last set
+    // the tail runs as well
+    size_t feed(std::string_view text, bool last);
+
+    // a whole file, mapped into memory
+    bool runFile(const std::string& path);
+    // everything left on a stream, read in large chunks
+    void runStream(std::FILE* in);
+
+    bool done() const { return count >= limit; }
+    size_t commands() const { return count; }
+};
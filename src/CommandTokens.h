@@ -0,0 +1,98 @@
+#pragma once
+#include <string_view>
+#include <charconv>
+#include <limits>
+
+// reads the fields of one command line the way a stringstream and >> did,
+// without copying anything: words come back as views into the line and
+// numbers are decoded in place. as with a stream, once a read fails every
+// later read fails too, giving "" or 0
+class CommandTokens {
+private:
+    std::string_view rest;
+    bool fail = false;
+
+    static bool isSpace(char c) {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+    }
+
+    void skipSpace() {
+        size_t i = 0;
+        while (i < rest.size() && isSpace(rest[i])) i++;
+        rest.remove_prefix(i);
+    }
+
+public:
+    explicit CommandTokens(std::string_view line) : rest(line) {}
+
+    bool failed() const { return fail; }
+
+    // the next run of non-space characters
+    std::string_view word() {
+        if (fail) return {};
+        skipSpace();
+        size_t i = 0;
+        while (i < rest.size() && !isSpace(rest[i])) i++;
+        if (i == 0) {
+            fail = true;
+            return {};
+        }
+        std::string_view w = rest.substr(0, i);
+        rest.remove_prefix(i);
+        return w;
+    }
+
+    // an optionally signed decimal int. digits stop at the first other
+    // character, which is left for the next read; out of range values fail
+    // clamped to the nearest limit
+    int number() {
+        if (fail) return 0;
+        skipSpace();
+        const char *first = rest.data();
+        const char *last = first + rest.size();
+        // from_chars takes '-' but not '+', so a '+' is dropped here and
+        // must be followed by a digit
+        if (first != last && *first == '+') {
+            first++;
+            if (first == last || *first < '0' || *first > '9') {
+                fail = true;
+                return 0;
+            }
+        }
+        int value = 0;
+        auto [end, ec] = std::from_chars(first, last, value);
+        if (ec == std::errc::invalid_argument) {
+            fail = true;
+            return 0;
+        }
+        rest.remove_prefix(end - rest.data());
+        if (ec == std::errc::result_out_of_range) {
+            fail = true;
+            return *first == '-' ? std::numeric_limits<int>::min() : std::numeric_limits<int>::max();
+        }
+        return value;
+    }
+
+    // the text between the next two double quotes; everything before the
+    // first is skipped. without a closing quote the rest of the line is the
+    // text and nothing is left to read
+    std::string_view quoted() {
+        if (fail) return {};
+        size_t open = rest.find('"');
+        if (open == std::string_view::npos) {
+            rest = {};
+            fail = true;
+            return {};
+        }
+        rest.remove_prefix(open + 1);
+        size_t close = rest.find('"');
+        std::string_view text = rest.substr(0, close);
+        if (close == std::string_view::npos) {
+            rest = {};
+            if (text.empty()) fail = true;
+        } else {
+            rest.remove_prefix(close + 1);
+        }
+        return text;
+    }
+};
@@ -0,0 +1,470 @@
+#include "ContractionHierarchy.h"
+#include "Graph.h"
+#include "SearchWorkspace.h"
+#include <algorithm>
+#include <functional>
+#include <limits>
+
+using namespace std;
+
+namespace {
+    // parts this small are ranked as they are; separating them gains nothing
+    const size_t LEAF_SIZE = 8;
+    // an edge is near when another walk of at most this many edges joins its
+    // ends, so it closes a small cycle the way walkways around a block do
+    const int NEAR_WALK = 5;
+    // how far that walk is looked for before the edge is taken as near
+    const size_t NEAR_SEARCH = 256;
+
+    // vertices by rank. a part is split at a level of a breadth first search
+    // from one of its far ends: the smallest one that leaves at least a
+    // quarter of the part on each side. long edges (the ones closing no
+    // small cycle, like a shortcut across the campus) would pull far away
+    // vertices into the first few levels, so the search only follows one
+    // once every near edge is used up, and a long edge that skips over the
+    // chosen level puts its upper end into the separator as well. the
+    // separator is ranked above both sides, which are split the same way
+    vector<int> dissectionOrder(const vector<vector<int>> &nbrs) {
+        int n = (int)nbrs.size();
+        vector<int> order(n);
+        int next = n;  // ranks are handed out from the top down
+        vector<int> part(n, 0);  // part id per vertex, -1 once ranked
+        vector<int> level(n, 0);
+        vector<int> seenBy(n, 0);
+        int parts = 0;
+        int searches = 0;
+        vector<int> reached;  // the last search's vertices, by level
+
+        // near and long neighbours
+        vector<vector<int>> near(n), far(n);
+        vector<int> frontier, ahead;
+        auto isNear = [&](int u, int v) {
+            int mark = ++searches;
+            size_t seen = 1;
+            frontier.assign(1, u);
+            seenBy[u] = mark;
+            for (int step = 0; step < NEAR_WALK && !frontier.empty(); step++) {
+                ahead.clear();
+                for (int x : frontier) {
+                    for (int y : nbrs[x]) {
+                        if (x == u && y == v) continue;
+                        if (y == v) return true;
+                        if (seenBy[y] == mark) continue;
+                        seenBy[y] = mark;
+                        ahead.push_back(y);
+                    }
+                }
+                seen += ahead.size();
+                if (seen > NEAR_SEARCH) return true;
+                swap(frontier, ahead);
+            }
+            return false;
+        };
+        for (int u = 0; u < n; u++) {
+            for (int v : nbrs[u]) {
+                if (v < u) continue;
+                bool close = isNear(u, v);
+                (close ? near : far)[u].push_back(v);
+                (close ? near : far)[v].push_back(u);
+            }
+        }
+
+        // levels grow by one along near edges; once those run out, the long
+        // edges out of everything reached start a new run of levels, one
+        // level apart from the last
+        auto bfs = [&](int src, int id) {
+            int mark = ++searches;
+            reached.clear();
+            reached.push_back(src);
+            seenBy[src] = mark;
+            level[src] = 0;
+            size_t head = 0;
+            size_t jumped = 0;  // reached vertices whose long edges are followed
+            while (true) {
+                for (; head < reached.size(); head++) {
+                    int u = reached[head];
+                    for (int v : near[u]) {
+                        if (part[v] != id || seenBy[v] == mark) continue;
+                        seenBy[v] = mark;
+                        level[v] = level[u] + 1;
+                        reached.push_back(v);
+                    }
+                }
+                int start = level[reached.back()] + 2;
+                for (size_t end = reached.size(); jumped < end; jumped++) {
+                    for (int v : far[reached[jumped]]) {
+                        if (part[v] != id || seenBy[v] == mark) continue;
+                        seenBy[v] = mark;
+                        level[v] = start;
+                        reached.push_back(v);
+                    }
+                }
+                if (head == reached.size()) break;
+            }
+        };
+        auto rankAll = [&](const vector<int> &vertices) {
+            for (int v : vertices) {
+                order[--next] = v;
+                part[v] = -1;
+            }
+        };
+
+        vector<vector<int>> pending(1);
+        for (int v = 0; v < n; v++) pending[0].push_back(v);
+        while (!pending.empty()) {
+            vector<int> vertices = move(pending.back());
+            pending.pop_back();
+            if (vertices.empty()) continue;
+            int id = ++parts;
+            for (int v : vertices) part[v] = id;
+
+            bfs(vertices[0], id);
+            if (reached.size() < vertices.size()) {
+                // not connected: the reached component and the rest are
+                // independent parts
+                vector<int> rest;
+                for (int v : vertices) {
+                    if (seenBy[v] != searches) rest.push_back(v);
+                }
+                pending.push_back(reached);
+                pending.push_back(move(rest));
+                continue;
+            }
+            if (vertices.size() <= LEAF_SIZE) {
+                rankAll(vertices);
+                continue;
+            }
+
+            bfs(reached.back(), id);
+            int depth = level[reached.back()];
+            if (depth < 2) {
+                rankAll(vertices);
+                continue;
+            }
+            // count[l]: vertices on level l. skips[l]: long edges jumping
+            // over level l, each adding a vertex to a separator there
+            vector<size_t> count(depth + 1, 0), skips(depth + 2, 0);
+            for (int u : reached) {
+                count[level[u]]++;
+                for (int v : far[u]) {
+                    if (part[v] != id || level[v] <= level[u] + 1) continue;
+                    skips[level[u] + 1]++;
+                    skips[level[v]]--;
+                }
+            }
+            for (int l = 1; l <= depth; l++) skips[l] += skips[l - 1];
+            size_t total = reached.size();
+            int cut = -1;
+            size_t before = count[0];
+            for (int l = 1; l < depth; l++) {
+                size_t after = total - before - count[l];
+                size_t size = count[l] + skips[l];
+                if (min(before, after) * 4 >= total && (cut < 0 || size < count[cut] + skips[cut])) cut = l;
+                before += count[l];
+            }
+            if (cut < 0) {
+                // lopsided levels: fall back to the one holding the median
+                before = count[0];
+                cut = 1;
+                while (cut < depth - 1 && before + count[cut] < total / 2) {
+                    before += count[cut];
+                    cut++;
+                }
+            }
+
+            vector<int> separator, low, high;
+            for (int u : reached) {
+                if (level[u] == cut) separator.push_back(u);
+                for (int v : far[u]) {
+                    if (part[v] == id && level[u] < cut && level[v] > cut) {
+                        separator.push_back(v);
+                        part[v] = 0;  // taken, so it is pushed only once
+                    }
+                }
+            }
+            for (int u : reached) {
+                if (part[u] != id || level[u] == cut) continue;
+                (level[u] < cut ? low : high).push_back(u);
+            }
+            rankAll(separator);
+            pending.push_back(move(low));
+            pending.push_back(move(high));
+        }
+        return order;
+    }
+}
+
+void ContractionHierarchy::clear() {
+    rank.clear();
+    order.clear();
+    parent.clear();
+    upOffsets.clear();
+    upTargets.clear();
+    upWeights.clear();
+    baseWeights.clear();
+    downOffsets.clear();
+    downArcs.clear();
+    arcState.clear();
+    previous.clear();
+    hasMetric = false;
+}
+
+void ContractionHierarchy::build(const CSR &g) {
+    int n = (int)g.offsets.size() - 1;
+    clear();
+    if (n <= 0) return;
+
+    // neighbour sets, sorted, no self loops
+    vector<vector<int>> nbrs(n);
+    for (int u = 0; u < n; u++) {
+        for (int a = g.offsets[u]; a < g.offsets[u + 1]; a++) {
+            if (g.targets[a] != u) nbrs[u].push_back(g.targets[a]);
+        }
+        sort(nbrs[u].begin(), nbrs[u].end());
+        nbrs[u].erase(unique(nbrs[u].begin(), nbrs[u].end()), nbrs[u].end());
+    }
+
+    order = dissectionOrder(nbrs);
+    rank.assign(n, 0);
+    for (int r = 0; r < n; r++) rank[order[r]] = r;
+
+    // eliminating r makes its upward neighbours a clique. all of that fill
+    // reaches the upward set of r's elimination tree parent, so each set
+    // only has to be handed to the parent rather than to every neighbour
+    parent.assign(n, -1);
+    vector<vector<int>> up(n);
+    for (int r = 0; r < n; r++) {
+        auto &set = up[r];
+        for (int x : nbrs[order[r]]) {
+            if (rank[x] > r) set.push_back(rank[x]);
+        }
+        sort(set.begin(), set.end());
+        set.erase(unique(set.begin(), set.end()), set.end());
+        set.erase(remove(set.begin(), set.end(), r), set.end());
+        if (set.empty()) continue;
+        parent[r] = set.front();
+        up[set.front()].insert(up[set.front()].end(), set.begin(), set.end());
+    }
+
+    upOffsets.assign(n + 1, 0);
+    for (int r = 0; r < n; r++) upOffsets[r + 1] = upOffsets[r] + (int)up[r].size();
+    upTargets.reserve(upOffsets[n]);
+    for (int r = 0; r < n; r++) upTargets.insert(upTargets.end(), up[r].begin(), up[r].end());
+
+    // lower ends come in rank order because the arcs are walked that way
+    downOffsets.assign(n + 1, 0);
+    for (int y : upTargets) downOffsets[y + 1]++;
+    for (int r = 0; r < n; r++) downOffsets[r + 1] += downOffsets[r];
+    downArcs.resize(upTargets.size());
+    vector<int> fill(downOffsets.begin(), downOffsets.end() - 1);
+    for (int r = 0; r < n; r++) {
+        for (int i = upOffsets[r]; i < upOffsets[r + 1]; i++) downArcs[fill[upTargets[i]]++] = {r, i};
+    }
+    arcState.assign(upTargets.size(), 0);
+    previous.assign(upTargets.size(), 0);
+}
+
+int ContractionHierarchy::findUpArc(int from, int to) const {
+    auto first = upTargets.begin() + upOffsets[from];
+    auto last = upTargets.begin() + upOffsets[from + 1];
+    auto it = lower_bound(first, last, to);
+    return (it != last && *it == to) ? (int)(it - upTargets.begin()) : -1;
+}
+
+int ContractionHierarchy::baseWeight(const CSR &g, int from, int to) const {
+    // the cheapest open original edge, of any parallel ones
+    int best = numeric_limits<int>::max();
+    for (int a = g.offsets[from]; a < g.offsets[from + 1]; a++) {
+        if (g.targets[a] == to && g.open[a]) best = min(best, g.weights[a]);
+    }
+    return best;
+}
+
+int ContractionHierarchy::lowerTriangles(int from, int to) const {
+    // the best path from - z - to over a lower ranked z adjacent to both
+    const int INF = numeric_limits<int>::max();
+    int best = INF;
+    int i = downOffsets[from];
+    int j = downOffsets[to];
+    while (i < downOffsets[from + 1] && j < downOffsets[to + 1]) {
+        int zi = downArcs[i].first;
+        int zj = downArcs[j].first;
+        if (zi != zj) {
+            if (zi < zj) i++;
+            else j++;
+            continue;
+        }
+        int wi = upWeights[downArcs[i].second];
+        int wj = upWeights[downArcs[j].second];
+        if (wi != INF && wj != INF) best = min(best, wi + wj);
+        i++;
+        j++;
+    }
+    return best;
+}
+
+void ContractionHierarchy::customize(const CSR &g) {
+    const int INF = numeric_limits<int>::max();
+    int n = (int)rank.size();
+    baseWeights.assign(upTargets.size(), INF);
+
+    // original open edges, cheapest of any parallel ones
+    for (int u = 0; u < n; u++) {
+        for (int a = g.offsets[u]; a < g.offsets[u + 1]; a++) {
+            int v = g.targets[a];
+            if (v == u || !g.open[a] || rank[u] > rank[v]) continue;
+            int arc = findUpArc(rank[u], rank[v]);
+            baseWeights[arc] = min(baseWeights[arc], g.weights[a]);
+        }
+    }
+    upWeights = baseWeights;
+
+    // bottom-up over the lower triangles: a path x - r - y through a lower
+    // ranked r bounds the shortcut between x and y. the upward neighbours
+    // of r form a clique, so walking those above x also walks the upward
+    // arcs of x
+    for (int r = 0; r < n; r++) {
+        for (int i = upOffsets[r]; i < upOffsets[r + 1]; i++) {
+            if (upWeights[i] == INF) continue;
+            int arc = upOffsets[upTargets[i]];
+            for (int j = i + 1; j < upOffsets[r + 1]; j++) {
+                while (upTargets[arc] != upTargets[j]) arc++;
+                if (upWeights[j] == INF) continue;
+                upWeights[arc] = min(upWeights[arc], upWeights[i] + upWeights[j]);
+            }
+        }
+    }
+    hasMetric = true;
+}
+
+void ContractionHierarchy::update(const CSR &g, const vector<pair<int,int>> &pairs) {
+    if (!hasMetric) return;
+    // an arc's weight is the best of its own edge and its lower triangles,
+    // and a triangle only changes with one of its two lower arcs. a cheaper
+    // triangle lowers the arc on the spot; a dearer one only matters when
+    // the arc's old weight came from it, and then the arc is redone from
+    // all of its lower triangles. arcs are finished in order of their lower
+    // end, as customize() does, so every triangle below an arc is final
+    // first, and the arcs sharing a lower end are finished together
+    const int INF = numeric_limits<int>::max();
+    const char TOUCHED = 1, REDO = 2;
+    using Item = pair<int,int>;  // (lower end, arc)
+    vector<Item> heap;
+    vector<int> touched;
+    auto later = greater<Item>();
+    // remembers the weight the arc had before this update and queues it
+    auto touch = [&](int lower, int arc, char redo) {
+        if (!arcState[arc]) {
+            previous[arc] = upWeights[arc];
+            touched.push_back(arc);
+            heap.push_back({lower, arc});
+            push_heap(heap.begin(), heap.end(), later);
+        }
+        arcState[arc] |= TOUCHED | redo;
+    };
+    auto before = [&](int arc) { return arcState[arc] ? previous[arc] : upWeights[arc]; };
+
+    for (auto [u, v] : pairs) {
+        if (u == v) continue;
+        int lower = rank[u] < rank[v] ? u : v;
+        int upper = lower == u ? v : u;
+        int arc = findUpArc(rank[lower], rank[upper]);
+        baseWeights[arc] = baseWeight(g, lower, upper);
+        touch(rank[lower], arc, REDO);
+    }
+    vector<int> batch;
+    while (!heap.empty()) {
+        int x = heap.front().first;
+        batch.clear();
+        while (!heap.empty() && heap.front().first == x) {
+            pop_heap(heap.begin(), heap.end(), later);
+            batch.push_back(heap.back().second);
+            heap.pop_back();
+        }
+        for (int arc : batch) {
+            if (arcState[arc] & REDO) upWeights[arc] = min(baseWeights[arc], lowerTriangles(x, upTargets[arc]));
+        }
+        // x is the lower vertex of a triangle under every pair of its
+        // upward neighbours
+        for (int arc : batch) {
+            int was = previous[arc];
+            int now = upWeights[arc];
+            if (was == now) continue;
+            int y = upTargets[arc];
+            // the upward neighbours of x form a clique, so those above y are
+            // upward neighbours of y too, in the same order
+            int j = upOffsets[y];
+            for (int i = upOffsets[x]; i < upOffsets[x + 1]; i++) {
+                int z = upTargets[i];
+                if (z == y) continue;
+                int top;
+                if (z < y) {
+                    top = findUpArc(z, y);
+                } else {
+                    while (upTargets[j] != z) j++;
+                    top = j;
+                }
+                int old = before(i);
+                bool tight = was != INF && old != INF && was + old == before(top);
+                int through = now == INF || upWeights[i] == INF ? INF : now + upWeights[i];
+                if (through < upWeights[top]) {
+                    touch(min(y, z), top, 0);
+                    upWeights[top] = through;
+                } else if (tight && through > was + old) {
+                    touch(min(y, z), top, REDO);
+                }
+            }
+        }
+    }
+    for (int arc : touched) arcState[arc] = 0;
+}
+
+int ContractionHierarchy::distance(SearchWorkspace &fw, SearchWorkspace &bw, int s, int t) const {
+    // every upward arc leads to an elimination tree ancestor, so the upward
+    // search space of a vertex is its ancestor chain, and walking the chain
+    // bottom-up settles each vertex after everything that can reach it; no
+    // priority queue is needed. the two chains are walked together, lowest
+    // rank first, and meet at the common ancestors, where the best meeting
+    // so far stops any vertex at least that far from relaxing its arcs
+    const int INF = numeric_limits<int>::max();
+    size_t n = rank.size();
+    fw.begin(n);
+    bw.begin(n);
+    // all arcs stay on the chain, so marking it up front leaves the
+    // relaxations a plain min
+    for (int r = rank[s]; r >= 0; r = parent[r]) fw.reach(r, INF, -1);
+    for (int r = rank[t]; r >= 0; r = parent[r]) bw.reach(r, INF, -1);
+    fw.dist[rank[s]] = 0;
+    bw.dist[rank[t]] = 0;
+
+    int best = INF;
+    auto settle = [&](SearchWorkspace &side, int r) {
+        int d = side.dist[r];
+        if (d >= best) return;
+        side.countSettled();
+        for (int i = upOffsets[r]; i < upOffsets[r + 1]; i++) {
+            int w = upWeights[i];
+            if (w == INF) continue;
+            int &to = side.dist[upTargets[i]];
+            to = min(to, d + w);
+        }
+    };
+    int x = rank[s];
+    int y = rank[t];
+    while (x != y) {
+        // below the lowest common ancestor the chains share nothing
+        if (y < 0 || (x >= 0 && x < y)) {
+            settle(fw, x);
+            x = parent[x];
+        } else {
+            settle(bw, y);
+            y = parent[y];
+        }
+    }
+    for (; x >= 0; x = parent[x]) {
+        if (fw.dist[x] != INF && bw.dist[x] != INF) best = min(best, fw.dist[x] + bw.dist[x]);
+        settle(fw, x);
+        settle(bw, x);
+    }
+    return best == INF ? -1 : best;
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <vector>
+#include <utility>
+#include <cstddef>
+
+struct CSR;
+class SearchWorkspace;
+
+// customizable contraction hierarchy over a Graph's CSR adjacency.
+// build() orders the vertices by nested dissection (small separators ranked
+// above the parts they split, recursively) and adds every fill-in edge of
+// that elimination order as a shortcut, so the result depends only on which
+// vertices are adjacent. customize() then derives shortcut weights for the
+// current edge weights, counting closed edges as missing; update() redoes
+// only the shortcuts that depend on a few toggled edges.
+class ContractionHierarchy {
+public:
+    bool built() const { return !rank.empty(); }
+    bool customized() const { return hasMetric; }
+
+    void build(const CSR& g);
+    void customize(const CSR& g);
+    // re-derive the shortcuts above these vertex pairs after their edges
+    // were opened or closed in g. a no-op until the first customize()
+    void update(const CSR& g, const std::vector<std::pair<int,int>>& pairs);
+    void clear();
+
+    // shortest distance between two vertices, -1 if there is no path
+    int distance(SearchWorkspace& fw, SearchWorkspace& bw, int s, int t) const;
+
+    // upward arcs, original edges included
+    size_t arcCount() const { return upTargets.size(); }
+
+private:
+    std::vector<int> rank;       // elimination position per vertex
+    std::vector<int> order;      // vertices by rank
+    // everything below is indexed by rank rather than vertex, so an arc's
+    // upper end is simply the larger number and a chain of ancestors sits
+    // close together in memory
+
+    // elimination tree: the lowest ranked upward neighbour, -1 at a root.
+    // every upward neighbour of r is an ancestor of r
+    std::vector<int> parent;
+    // upward graph: the arcs of r go to its higher ranked neighbours at the
+    // time it was eliminated, in rank order
+    std::vector<int> upOffsets;
+    std::vector<int> upTargets;
+    std::vector<int> upWeights;
+    std::vector<int> baseWeights;  // cheapest open original edge per arc
+    // the same arcs seen from their upper end: (lower end, arc) for each
+    // lower neighbour, in rank order
+    std::vector<int> downOffsets;
+    std::vector<std::pair<int,int>> downArcs;
+    bool hasMetric = false;
+    // per arc, scratch for update(): whether it was reached and must be
+    // redone, and its weight from before the update
+    std::vector<char> arcState;
+    std::vector<int> previous;
+
+    int findUpArc(int from, int to) const;
+    int baseWeight(const CSR& g, int from, int to) const;
+    int lowerTriangles(int from, int to) const;
+};
@@ -0,0 +1,108 @@
+#pragma once
+#include <string_view>
+#include <charconv>
+#include <cstring>
+
+// walks the rows of a whole csv file held in memory, handing out fields as
+// views into it. lines and fields are found with memchr, which the c library
+// vectorizes, and numbers are decoded in place. once a read fails every
+// later read on the row fails too, giving "" or 0
+class CsvRows {
+private:
+    std::string_view rest;  // the rows not reached yet
+    std::string_view row;   // the fields of the current row not read yet
+    bool fail = false;
+    bool rowEnded = false;  // the last field of the row has been read
+
+    static const char* find(std::string_view text, char c) {
+        return text.empty() ? nullptr : static_cast<const char*>(std::memchr(text.data(), c, text.size()));
+    }
+
+    // an optionally signed decimal int at the start of text, after any
+    // spaces, the way stoi reads one; anything after the digits is ignored
+    static bool parseInt(std::string_view text, int &value) {
+        const char *first = text.data();
+        const char *last = first + text.size();
+        while (first != last && (*first == ' ' || *first == '\t')) first++;
+        if (first != last && *first == '+') {
+            first++;
+            if (first == last || *first < '0' || *first > '9') return false;
+        }
+        auto [end, ec] = std::from_chars(first, last, value);
+        return ec == std::errc();
+    }
+
+public:
+    explicit CsvRows(std::string_view text) : rest(text) {}
+
+    // lines in text, counting a last one with no newline
+    static size_t countLines(std::string_view text) {
+        size_t lines = 0;
+        while (const char *nl = find(text, '\n')) {
+            lines++;
+            text.remove_prefix(nl - text.data() + 1);
+        }
+        return lines + !text.empty();
+    }
+
+    bool failed() const { return fail; }
+
+    // moves to the next non-blank row, false at the end of the text. a
+    // trailing '\r' is dropped
+    bool nextRow() {
+        while (!rest.empty()) {
+            const char *nl = find(rest, '\n');
+            size_t len = nl ? (size_t)(nl - rest.data()) : rest.size();
+            row = rest.substr(0, len);
+            rest.remove_prefix(nl ? len + 1 : len);
+            if (!row.empty() && row.back() == '\r') row.remove_suffix(1);
+            if (row.empty()) continue;
+            fail = false;
+            rowEnded = false;
+            return true;
+        }
+        return false;
+    }
+
+    // the text up to the next comma, or to the end of the row
+    std::string_view field() {
+        if (fail) return {};
+        if (rowEnded) {
+            fail = true;
+            return {};
+        }
+        const char *comma = find(row, ',');
+        if (!comma) {
+            rowEnded = true;
+            std::string_view last = row;
+            row = {};
+            return last;
+        }
+        std::string_view text = row.substr(0, comma - row.data());
+        row.remove_prefix(text.size() + 1);
+        return text;
+    }
+
+    // a field holding an int
+    int integer() {
+        std::string_view text = field();
+        int value = 0;
+        if (!fail && !parseInt(text, value)) fail = true;
+        return fail ? 0 : value;
+    }
+
+    // a field holding an HH:MM clock time, as minutes after midnight
+    int minutes() {
+        std::string_view text = field();
+        if (fail) return 0;
+        size_t colon = text.find(':');
+        int hours = 0;
+        int mins = 0;
+        if (colon == std::string_view::npos || !parseInt(text.substr(0, colon), hours)
+            || !parseInt(text.substr(colon + 1), mins)) {
+            fail = true;
+            return 0;
+        }
+        return hours * 60 + mins;
+    }
+};
@@ -1,4 +1,6 @@
 #include "Graph.h"
+#include "SearchWorkspace.h"
+#include "Snapshot.h"
 #include <queue>
 #include <limits>
 #include <algorithm>
@@ -7,197 +9,1223 @@
 
 using namespace std;
 
-void Graph::addLocation(int id, const std::string &name) {
+namespace {
+    uint64_t edgeKey(int a, int b) {
+        if (a > b) std::swap(a, b);
+        return (uint64_t)(uint32_t)a << 32 | (uint32_t)b;
+    }
+}
+
+int Graph::internVertex(int id) {
+    auto it = index.find(id);
+    if (it != index.end()) return it->second;
+    int v = (int)ids.size();
+    index[id] = v;
+    ids.push_back(id);
+    csrDirty = true;
+    structureChanged = ++changes;
+    return v;
+}
+
+int Graph::vertexIndex(int id) const {
+    // only vertices with at least one edge count as part of the graph
+    auto it = index.find(id);
+    if (it == index.end()) return -1;
+    const CSR &g = adjacency();
+    return g.degree(it->second) > 0 ? it->second : -1;
+}
+
+const CSR &Graph::adjacency() const {
+    lock_guard<recursive_mutex> hold(lazy.m);
+    if (csrDirty) buildCSR();
+    return csr;
+}
+
+void Graph::buildCSR() const {
+    int n = (int)ids.size();
+    csr.offsets.assign(n + 1, 0);
+    for (const auto &e : edges) {
+        csr.offsets[e.u + 1]++;
+        csr.offsets[e.v + 1]++;
+    }
+    for (int u = 0; u < n; u++) csr.offsets[u + 1] += csr.offsets[u];
+
+    size_t arcs = edges.size() * 2;
+    csr.targets.resize(arcs);
+    csr.weights.resize(arcs);
+    csr.open.resize(arcs);
+    csr.edge.resize(arcs);
+    csr.reverse.resize(arcs);
+    csr.arcOf.resize(edges.size());
+
+    // edges are placed in insertion order so each vertex sees its arcs in the
+    // same order the old per-vertex vectors did
+    vector<int> next(csr.offsets.begin(), csr.offsets.end() - 1);
+    for (int i = 0; i < (int)edges.size(); i++) {
+        const auto &e = edges[i];
+        int a = next[e.u]++;
+        csr.targets[a] = e.v;
+        csr.weights[a] = e.weight;
+        csr.open[a] = e.open;
+        csr.edge[a] = i;
+
+        int b = next[e.v]++;
+        csr.targets[b] = e.u;
+        csr.weights[b] = e.weight;
+        csr.open[b] = e.open;
+        csr.edge[b] = i;
+
+        csr.reverse[a] = b;
+        csr.reverse[b] = a;
+        csr.arcOf[i] = a;
+    }
+    csr.minWeight = csr.maxWeight = 0;
+    for (const auto &e : edges) {
+        csr.minWeight = min(csr.minWeight, e.weight);
+        csr.maxWeight = max(csr.maxWeight, e.weight);
+    }
+    csrDirty = false;
+    distCache.reset();
+    components.reset();
+    landmarks.fresh = false;
+    hierarchy.clear();
+}
+
+void Graph::chooseQueue(SearchWorkspace &ws) const {
+    // call after ws.begin(). with small integer weights the queued keys all
+    // sit within maxWeight of the smallest, so a ring of buckets replaces
+    // the heap's log factor. only for searches where equal keys may settle
+    // in any order: distances and costs, not the routes that are printed
+    const CSR &g = adjacency();
+    if (bucketLimit > 0 && g.minWeight >= 0 && g.maxWeight <= bucketLimit) ws.useBuckets(g.maxWeight);
+}
+
+int Graph::findEdge(int a, int b) const {
+    auto it = edgeIndex.find(edgeKey(a, b));
+    return it == edgeIndex.end() ? -1 : it->second;
+}
+
+void Graph::reserve(size_t locations, size_t edgeCount) {
+    index.reserve(locations);
+    ids.reserve(locations);
+    names.reserve(locations);
+    edges.reserve(edgeCount);
+    edgeIndex.reserve(edgeCount);
+}
+
+void Graph::addLocation(int id, string_view name) {
+    internVertex(id);
     // don't overwrite existing name if already present
     if (names.find(id) == names.end()) {
-        names[id] = name;
+        names.emplace(id, name);
+        changes++;
     }
 }
 
 void Graph::addEdge(int a, int b, int weight) {
     // add nodes if missing
-    if (adj.find(a) == adj.end()) adj[a] = {};
-    if (adj.find(b) == adj.end()) adj[b] = {};
-
-    // add edge a->b
-    Edge e1;
-    e1.to = b;
-    e1.weight = weight;
-    e1.open = true;
-    adj[a].push_back(e1);
+    int u = internVertex(a);
+    int v = internVertex(b);
 
-    // add edge b->a
-    Edge e2;
-    e2.to = a;
-    e2.weight = weight;
-    e2.open = true;
-    adj[b].push_back(e2);
+    // one record per undirected edge, expanded into both arcs by buildCSR
+    edgeIndex.emplace(edgeKey(a, b), (int)edges.size());
+    structureChanged = ++changes;
+    edges.push_back({u, v, weight, true, changes});
+    csrDirty = true;
 }
 
 void Graph::toggleEdge(int a, int b) {
-    auto it = adj.find(a);
-    if (it != adj.end()) {
-        for (auto &e : it->second) {
-            if (e.to == b) {
-                e.open = !e.open;
-                break;
+    int e = findEdge(a, b);
+    if (e < 0) return;
+    flipEdges(&e, 1);
+}
+
+void Graph::toggleEdges(const std::vector<std::pair<int,int>> &pairs) {
+    vector<int> flipped;
+    flipped.reserve(pairs.size());
+    for (const auto &[a, b] : pairs) {
+        int e = findEdge(a, b);
+        if (e >= 0) flipped.push_back(e);
+    }
+
+    // an edge toggled an even number of times ends up where it started
+    sort(flipped.begin(), flipped.end());
+    size_t kept = 0;
+    for (size_t i = 0; i < flipped.size();) {
+        size_t j = i;
+        while (j < flipped.size() && flipped[j] == flipped[i]) j++;
+        if ((j - i) % 2 == 1) flipped[kept++] = flipped[i];
+        i = j;
+    }
+    flipEdges(flipped.data(), kept);
+}
+
+void Graph::flipEdges(const int *changed, size_t count) {
+    if (count == 0) return;
+    changes++;
+    // once the log outgrows the graph, older history is dropped and caches
+    // from before it recompute instead of replaying it
+    if (flipLog.size() + count > 2 * edges.size() + 64) {
+        flipLog.clear();
+        historyStart = changes - 1;
+    }
+    for (size_t i = 0; i < count; i++) {
+        auto &e = edges[changed[i]];
+        e.open = !e.open;
+        e.changed = changes;
+        flipLog.push_back({changes, changed[i]});
+    }
+    // a pending rebuild picks the new state up from the edge records
+    if (csrDirty) return;
+
+    for (size_t i = 0; i < count; i++) {
+        int arc = csr.arcOf[changed[i]];
+        csr.open[arc] = csr.open[csr.reverse[arc]] = edges[changed[i]].open;
+    }
+    // one round of index maintenance for the whole batch
+    repairCachedRows(changed, count);
+    updateComponents(changed, count);
+    // closures only lengthen paths, so the landmark bounds stay valid lower
+    // bounds; a reopened edge can make them overestimate
+    for (size_t i = 0; i < count; i++) {
+        if (edges[changed[i]].open) landmarks.fresh = false;
+    }
+    // closed edges weigh infinity in the hierarchy, so a flip changes the
+    // shortcuts above the edge but never the ordering
+    if (hierarchy.customized()) {
+        vector<pair<int,int>> ends;
+        ends.reserve(count);
+        for (size_t i = 0; i < count; i++) ends.push_back({edges[changed[i]].u, edges[changed[i]].v});
+        hierarchy.update(csr, ends);
+    }
+}
+
+template <class F>
+bool Graph::forEachToggledSince(uint64_t since, F visit) const {
+    if (since < structureChanged || since < historyStart) return false;
+    auto first = std::upper_bound(flipLog.begin(), flipLog.end(), since,
+        [](uint64_t v, const std::pair<uint64_t,int>& entry) { return v < entry.first; });
+    for (auto it = first; it != flipLog.end(); ++it) {
+        // an edge toggled again later is visited at its last entry only
+        if (edges[it->second].changed == it->first) visit(it->second);
+    }
+    return true;
+}
+
+uint64_t Graph::edgeVersion(int a, int b) const {
+    int e = findEdge(a, b);
+    return e < 0 ? 0 : edges[e].changed;
+}
+
+bool Graph::toggledSince(uint64_t since, std::vector<std::pair<int,int>> &pairs) const {
+    pairs.clear();
+    return forEachToggledSince(since, [&](int e) {
+        pairs.push_back({ids[edges[e].u], ids[edges[e].v]});
+    });
+}
+
+std::string Graph::edgeStatus(int a, int b) const {
+    int e = findEdge(a, b);
+    if (e < 0) return "DNE";
+    return edges[e].open ? "open" : "closed";
+}
+
+bool Graph::isConnected(int a, int b) const {
+    int s = vertexIndex(a);
+    int t = vertexIndex(b);
+    if (s < 0 || t < 0) return false;
+    lock_guard<recursive_mutex> hold(lazy.m);
+    // relabelling t's component can move s to a new label as well, so read
+    // s's label only after both are clean
+    componentOf(s);
+    int ct = componentOf(t);
+    return components.label[s] == ct;
+}
+
+int Graph::componentOf(int v) const {
+    const CSR &g = adjacency();
+    auto &c = components;
+    size_t n = ids.size();
+    // fresh labels pile up as dirty components get split; start over once
+    // they clearly outnumber the vertices
+    if (c.built && c.size.size() > 2 * n + 16) c.reset();
+    if (!c.built) {
+        SearchWorkspace::Lease ws;
+        c.label.assign(n, -1);
+        for (size_t u = 0; u < n; u++) {
+            if (c.label[u] < 0 && g.degree(u) > 0) labelComponent(*ws, u);
+        }
+        c.built = true;
+    }
+    if (c.dirty[c.label[v]]) {
+        SearchWorkspace::Lease ws;
+        labelComponent(*ws, v);
+    }
+    return c.label[v];
+}
+
+void Graph::labelComponent(SearchWorkspace &ws, int v) const {
+    // give everything reachable from v over open edges a new clean label
+    const CSR &g = adjacency();
+    auto &c = components;
+    int fresh = (int)c.size.size();
+    ws.begin(ids.size());
+    ws.visit(v);
+    ws.enqueue(v);
+    for (size_t head = 0; head < ws.queue.size(); head++) {
+        int u = ws.queue[head];
+        c.label[u] = fresh;
+        for (int a = g.offsets[u]; a < g.offsets[u + 1]; a++) {
+            if (!g.open[a]) continue;
+            int w = g.targets[a];
+            if (!ws.visited(w)) {
+                ws.visit(w);
+                ws.enqueue(w);
             }
         }
     }
-    auto it2 = adj.find(b);
-    if (it2 != adj.end()) {
-        for (auto &e : it2->second) {
-            if (e.to == a) {
-                e.open = !e.open;
-                break;
+    c.size.push_back((int)ws.queue.size());
+    c.dirty.push_back(0);
+}
+
+void Graph::updateComponents(const int *changed, size_t count) {
+    auto &c = components;
+    if (!c.built) return;
+
+    // closures first: a label that is still clean afterwards was not cut,
+    // so its vertices are connected and can be relabelled by a walk below
+    for (size_t i = 0; i < count; i++) {
+        const EdgeRecord &e = edges[changed[i]];
+        // the component may have split; find out when it is next asked about
+        if (!e.open) c.dirty[c.label[e.u]] = 1;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        const EdgeRecord &e = edges[changed[i]];
+        if (!e.open) continue;
+        int lu = c.label[e.u];
+        int lv = c.label[e.v];
+        if (lu == lv) continue;
+        if (c.dirty[lu] || c.dirty[lv]) {
+            // a clean label must cover its whole component, which now
+            // includes the dirty side as well
+            c.dirty[lu] = c.dirty[lv] = 1;
+            continue;
+        }
+
+        // two clean components joined: move the smaller one over to the larger
+        int from = c.size[lu] < c.size[lv] ? lu : lv;
+        int to = from == lu ? lv : lu;
+        int start = from == lu ? e.u : e.v;
+        SearchWorkspace::Lease ws;
+        ws->begin(ids.size());
+        c.label[start] = to;
+        ws->enqueue(start);
+        for (size_t head = 0; head < ws->queue.size(); head++) {
+            int u = ws->queue[head];
+            for (int a = csr.offsets[u]; a < csr.offsets[u + 1]; a++) {
+                int w = csr.targets[a];
+                if (csr.open[a] && c.label[w] == from) {
+                    c.label[w] = to;
+                    ws->enqueue(w);
+                }
             }
         }
+        c.size[to] += c.size[from];
+        c.size[from] = 0;
     }
 }
 
-std::string Graph::edgeStatus(int a, int b) const {
-    auto it = adj.find(a);
-    if (it == adj.end()) return "DNE";
-    for (const auto &e : it->second) {
-        if (e.to == b) {
-            return e.open ? "open" : "closed";
+void Graph::setDistanceCacheBudget(size_t budgetBytes) {
+    distCache.budgetBytes = budgetBytes;
+    distCache.reset();
+}
+
+bool Graph::distanceCacheActive() const {
+    size_t n = ids.size();
+    return n > 0 && 2 * n * n <= distCache.budgetBytes / sizeof(int);
+}
+
+const int *Graph::cachedRow(int s) const {
+    if (!distanceCacheActive()) return nullptr;
+    lock_guard<recursive_mutex> hold(lazy.m);
+    size_t n = ids.size();
+    if (distCache.n != n) {
+        distCache.n = n;
+        distCache.matrix.assign(n * n, -1);
+        distCache.parents.assign(n * n, -1);
+        distCache.rowReady.assign(n, 0);
+    }
+    int *row = distCache.matrix.data() + (size_t)s * n;
+    if (distCache.rowReady[s]) return row;
+
+    SearchWorkspace::Lease ws;
+    searchFrom(*ws, s);
+    int *parent = distCache.parents.data() + (size_t)s * n;
+    for (size_t v = 0; v < n; v++) {
+        row[v] = ws->reached(v) ? ws->dist[v] : -1;
+        parent[v] = ws->reached(v) ? ws->parent[v] : -1;
+    }
+    distCache.rowReady[s] = 1;
+    return row;
+}
+
+void Graph::setDistanceTableSources(const std::vector<int> &sources) {
+    assignTableSources(sources);
+    for (int id : sourceTable.sources) tableColumn(id);
+}
+
+void Graph::assignTableSources(const std::vector<int> &sources) {
+    sourceTable = SourceTable();
+    for (int id : sources) {
+        if (!sourceTable.column.emplace(id, (int)sourceTable.sources.size()).second) continue;
+        sourceTable.sources.push_back(id);
+    }
+}
+
+bool Graph::distanceTableReady() const {
+    lock_guard<recursive_mutex> hold(lazy.m);
+    if (sourceTable.sources.empty()) return true;
+    if (sourceTable.n != ids.size()) return false;
+    for (uint64_t computed : sourceTable.version) {
+        if (computed != changes) return false;
+    }
+    return true;
+}
+
+const int *Graph::tableColumn(int id) const {
+    lock_guard<recursive_mutex> hold(lazy.m);
+    auto it = sourceTable.column.find(id);
+    if (it == sourceTable.column.end()) return nullptr;
+    size_t n = ids.size();
+    if (sourceTable.n != n) {
+        // new locations; every column gets recomputed at the new size
+        sourceTable.n = n;
+        sourceTable.dist.assign(sourceTable.sources.size() * n, -1);
+        sourceTable.version.assign(sourceTable.sources.size(), ~uint64_t(0));
+    }
+
+    int c = it->second;
+    int *col = sourceTable.dist.data() + (size_t)c * n;
+    uint64_t computed = sourceTable.version[c];
+    if (computed == changes) return col;
+    if (computed == ~uint64_t(0) || !columnStillExact(col, computed)) {
+        int s = vertexIndex(id);
+        if (s < 0) {
+            fill(col, col + n, -1);
+        } else {
+            SearchWorkspace::Lease ws;
+            searchFrom(*ws, s);
+            for (size_t v = 0; v < n; v++) col[v] = ws->reached(v) ? ws->dist[v] : -1;
         }
     }
-    return "DNE";
+    sourceTable.version[c] = changes;
+    return col;
 }
 
-bool Graph::isConnected(int a, int b) const {
-    if (adj.find(a) == adj.end() || adj.find(b) == adj.end()) return false;
-    unordered_set<int> visited;
-    queue<int> q;
-    q.push(a);
-    visited.insert(a);
-    while (!q.empty()) {
-        int u = q.front(); q.pop();
-        if (u == b) return true;
-        auto it = adj.find(u);
-        if (it == adj.end()) continue;
-        for (const auto &e : it->second) {
-            if (!e.open) continue;
-            if (visited.find(e.to) == visited.end()) {
-                visited.insert(e.to);
-                q.push(e.to);
+bool Graph::columnStillExact(const int *col, uint64_t since) const {
+    // distances stay exact as long as no closed edge was tight (so on some
+    // shortest path) and no opened edge offers a shorter way anywhere.
+    // checking the current state of each toggled edge covers any history
+    bool exact = true;
+    bool known = forEachToggledSince(since, [&](int e) {
+        const auto &r = edges[e];
+        int du = col[r.u];
+        int dv = col[r.v];
+        if (r.open) {
+            if (du >= 0 && (dv < 0 || du + r.weight < dv)) exact = false;
+            if (dv >= 0 && (du < 0 || dv + r.weight < du)) exact = false;
+        } else if (du >= 0 && dv >= 0 && (du + r.weight == dv || dv + r.weight == du)) {
+            exact = false;
+        }
+    });
+    return known && exact;
+}
+
+void Graph::writeSnapshot(SnapshotWriter &out, bool withDistanceTables) const {
+    const CSR &g = adjacency();
+    out.putArray(ids);
+
+    // names by id, so the same graph always gives the same bytes
+    vector<int> named;
+    named.reserve(names.size());
+    for (const auto &[id, name] : names) named.push_back(id);
+    sort(named.begin(), named.end());
+    out.put<uint64_t>(named.size());
+    for (int id : named) {
+        out.put<int>(id);
+        out.putString(names.at(id));
+    }
+
+    out.put<uint64_t>(edges.size());
+    for (const auto &e : edges) {
+        out.put<int>(e.u);
+        out.put<int>(e.v);
+        out.put<int>(e.weight);
+        out.put<char>(e.open);
+    }
+
+    out.putArray(g.offsets);
+    out.putArray(g.targets);
+    out.putArray(g.weights);
+    out.putArray(g.open);
+    out.putArray(g.edge);
+    out.putArray(g.reverse);
+    out.putArray(g.arcOf);
+    out.put<int>(g.minWeight);
+    out.put<int>(g.maxWeight);
+
+    // a column goes in only if it is exact for the graph as saved
+    out.putArray(sourceTable.sources);
+    for (int id : sourceTable.sources) {
+        const int *col = withDistanceTables ? tableColumn(id) : nullptr;
+        out.put<char>(col != nullptr);
+        if (col) out.putArray(col, ids.size());
+    }
+}
+
+bool Graph::readSnapshot(SnapshotReader &in) {
+    if (!ids.empty() || !edges.empty()) return false;
+
+    // everything is read and checked before the graph is touched
+    vector<int> newIds;
+    in.getArray(newIds);
+    int n = (int)newIds.size();
+    unordered_map<int, int> newIndex;
+    newIndex.reserve(n);
+    for (int v = 0; v < n; v++) {
+        if (!newIndex.emplace(newIds[v], v).second) return false;
+    }
+
+    uint64_t nameCount = in.get<uint64_t>();
+    unordered_map<int, string> newNames;
+    for (uint64_t i = 0; i < nameCount && !in.failed(); i++) {
+        int id = in.get<int>();
+        string_view name = in.getString();
+        if (!newIndex.count(id)) return false;
+        newNames.emplace(id, name);
+    }
+
+    uint64_t edgeCount = in.get<uint64_t>();
+    if (in.failed() || edgeCount > in.remaining() / (3 * sizeof(int) + 1)) return false;
+    vector<EdgeRecord> newEdges;
+    newEdges.reserve(edgeCount);
+    for (uint64_t i = 0; i < edgeCount && !in.failed(); i++) {
+        int u = in.get<int>();
+        int v = in.get<int>();
+        int weight = in.get<int>();
+        bool open = in.get<char>() != 0;
+        if (u < 0 || u >= n || v < 0 || v >= n) return false;
+        newEdges.push_back({u, v, weight, open, 1});
+    }
+
+    CSR loaded;
+    in.getArray(loaded.offsets);
+    in.getArray(loaded.targets);
+    in.getArray(loaded.weights);
+    in.getArray(loaded.open);
+    in.getArray(loaded.edge);
+    in.getArray(loaded.reverse);
+    in.getArray(loaded.arcOf);
+    loaded.minWeight = in.get<int>();
+    loaded.maxWeight = in.get<int>();
+    if (in.failed()) return false;
+
+    // the arrays must fit together, or searches would run off them
+    int m = (int)newEdges.size();
+    size_t arcs = newEdges.size() * 2;
+    if (loaded.offsets.size() != (size_t)n + 1 || loaded.offsets[0] != 0 || loaded.offsets[n] != (int)arcs) return false;
+    if (loaded.targets.size() != arcs || loaded.weights.size() != arcs || loaded.open.size() != arcs
+        || loaded.edge.size() != arcs || loaded.reverse.size() != arcs || loaded.arcOf.size() != newEdges.size()) return false;
+    for (int u = 0; u < n; u++) {
+        if (loaded.offsets[u] > loaded.offsets[u + 1]) return false;
+    }
+    for (size_t a = 0; a < arcs; a++) {
+        if (loaded.targets[a] < 0 || loaded.targets[a] >= n || loaded.edge[a] < 0 || loaded.edge[a] >= m
+            || loaded.reverse[a] < 0 || (size_t)loaded.reverse[a] >= arcs) return false;
+    }
+    for (int a : loaded.arcOf) {
+        if (a < 0 || (size_t)a >= arcs) return false;
+    }
+
+    // and describe exactly the edge records: each edge has one arc at each
+    // end, the two linked through reverse and carrying its weight and state,
+    // or toggles would flip the wrong arcs and the bucket ring be misjudged
+    vector<int> source(arcs);
+    for (int u = 0; u < n; u++) {
+        for (int a = loaded.offsets[u]; a < loaded.offsets[u + 1]; a++) source[a] = u;
+    }
+    vector<char> arcCount(m, 0);
+    for (size_t a = 0; a < arcs; a++) {
+        const auto &e = newEdges[loaded.edge[a]];
+        int b = loaded.reverse[a];
+        bool ends = (source[a] == e.u && loaded.targets[a] == e.v) || (source[a] == e.v && loaded.targets[a] == e.u);
+        if ((size_t)b == a || loaded.reverse[b] != (int)a || loaded.edge[b] != loaded.edge[a] || source[b] != loaded.targets[a]
+            || !ends || loaded.weights[a] != e.weight || (loaded.open[a] != 0) != e.open) return false;
+        if (++arcCount[loaded.edge[a]] > 2) return false;
+    }
+    int minWeight = 0;
+    int maxWeight = 0;
+    for (int i = 0; i < m; i++) {
+        int a = loaded.arcOf[i];
+        if (loaded.edge[a] != i || source[a] != newEdges[i].u) return false;
+        minWeight = min(minWeight, newEdges[i].weight);
+        maxWeight = max(maxWeight, newEdges[i].weight);
+    }
+    if (loaded.minWeight != minWeight || loaded.maxWeight != maxWeight) return false;
+
+    vector<int> sources;
+    in.getArray(sources);
+    vector<vector<int>> columns(sources.size());
+    for (size_t c = 0; c < sources.size() && !in.failed(); c++) {
+        if (!in.get<char>()) continue;
+        in.getArray(columns[c]);
+        if (columns[c].size() != (size_t)n) return false;
+    }
+    if (in.failed()) return false;
+
+    index.swap(newIndex);
+    ids.swap(newIds);
+    names.swap(newNames);
+    edges.swap(newEdges);
+    for (int i = 0; i < m; i++) edgeIndex.emplace(edgeKey(ids[edges[i].u], ids[edges[i].v]), i);
+    structureChanged = ++changes;
+    for (auto &e : edges) e.changed = changes;
+
+    csr = move(loaded);
+    csrDirty = false;
+    distCache.reset();
+    components.reset();
+    landmarks.fresh = false;
+    hierarchy.clear();
+
+    assignTableSources(sources);
+    sourceTable.n = n;
+    sourceTable.dist.assign(sourceTable.sources.size() * n, -1);
+    sourceTable.version.assign(sourceTable.sources.size(), ~uint64_t(0));
+    for (size_t c = 0; c < sources.size(); c++) {
+        auto it = sourceTable.column.find(sources[c]);
+        if (columns[c].empty() || it == sourceTable.column.end()) continue;
+        copy(columns[c].begin(), columns[c].end(), sourceTable.dist.begin() + (size_t)it->second * n);
+        sourceTable.version[it->second] = changes;
+    }
+    // columns the snapshot left out are computed now, as
+    // setDistanceTableSources would
+    for (int id : sourceTable.sources) tableColumn(id);
+    return true;
+}
+
+void Graph::repairCachedRows(const int *changed, size_t count) {
+    if (distCache.n == 0) return;
+    size_t n = distCache.n;
+    SearchWorkspace::Lease ws;
+    for (size_t s = 0; s < n; s++) {
+        if (!distCache.rowReady[s]) continue;
+        int *dist = distCache.matrix.data() + s * n;
+        int *parent = distCache.parents.data() + s * n;
+        repairRow(*ws, dist, parent, changed, count);
+    }
+}
+
+void Graph::repairRow(SearchWorkspace &ws, int *dist, int *parent, const int *changed, size_t count) {
+    ws.begin(ids.size());
+    auto later = greater<SearchWorkspace::HeapItem>();
+
+    // a closed arc x -> y only matters if the tree reaches y through it.
+    // the subtrees under such arcs may get longer; every other vertex keeps
+    // its tree path, so its distance is still achievable
+    for (size_t i = 0; i < count; i++) {
+        if (edges[changed[i]].open) continue;
+        int arc = csr.arcOf[changed[i]];
+        for (int a : {arc, csr.reverse[arc]}) {
+            int x = csr.targets[csr.reverse[a]];
+            int y = csr.targets[a];
+            if (dist[x] < 0 || parent[y] != x || dist[y] != dist[x] + csr.weights[a]) continue;
+            if (!ws.visited(y)) {
+                ws.visit(y);
+                ws.enqueue(y);
+            }
+        }
+    }
+    for (size_t head = 0; head < ws.queue.size(); head++) {
+        int z = ws.queue[head];
+        for (int a = csr.offsets[z]; a < csr.offsets[z + 1]; a++) {
+            int c = csr.targets[a];
+            if (parent[c] == z && !ws.visited(c)) {
+                ws.visit(c);
+                ws.enqueue(c);
             }
         }
     }
-    return false;
+    for (int z : ws.queue) {
+        dist[z] = -1;
+        parent[z] = -1;
+    }
+
+    auto offer = [&](int v, int d, int from) {
+        if (dist[v] >= 0 && d >= dist[v]) return;
+        dist[v] = d;
+        parent[v] = from;
+        ws.pushHeap({d, v}, later);
+    };
+    // reset vertices start again from their best open arc into them, and
+    // opened arcs may shortcut anything
+    for (int z : ws.queue) {
+        for (int a = csr.offsets[z]; a < csr.offsets[z + 1]; a++) {
+            int w = csr.targets[a];
+            if (dist[w] >= 0 && csr.open[csr.reverse[a]]) offer(z, dist[w] + csr.weights[a], w);
+        }
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (!edges[changed[i]].open) continue;
+        int arc = csr.arcOf[changed[i]];
+        for (int a : {arc, csr.reverse[arc]}) {
+            int x = csr.targets[csr.reverse[a]];
+            if (dist[x] >= 0) offer(csr.targets[a], dist[x] + csr.weights[a], x);
+        }
+    }
+
+    // push the decreases outwards for as long as they keep improving vertices
+    while (!ws.heap.empty()) {
+        auto [d,u] = ws.popHeap(later);
+        if (d != dist[u]) continue;
+        for (int a = csr.offsets[u]; a < csr.offsets[u + 1]; a++) {
+            if (csr.open[a]) offer(csr.targets[a], d + csr.weights[a], u);
+        }
+    }
 }
 
 int Graph::shortestPath(int src, int dst) const {
-    if (adj.find(src) == adj.end() || adj.find(dst) == adj.end()) return -1;
-    const int INF = std::numeric_limits<int>::max();
-    unordered_map<int, int> dist;
+    int s = vertexIndex(src);
+    int t = vertexIndex(dst);
+    if (s < 0 || t < 0) return -1;
+
+    // edges are undirected, so a column for either end holds the answer
+    if (const int *col = tableColumn(dst)) return col[s];
+    if (const int *col = tableColumn(src)) return col[t];
+
+    // likewise, either endpoint's row will do
+    if (distanceCacheActive()) {
+        lock_guard<recursive_mutex> hold(lazy.m);
+        if (distCache.n == ids.size() && distCache.rowReady[t]) {
+            return distCache.matrix[(size_t)t * ids.size() + s];
+        }
+        return cachedRow(s)[t];
+    }
+
+    SearchWorkspace::Lease ws;
+    switch (pathSearch) {
+        case PathSearch::Landmarks:
+            return landmarkSearch(*ws, s, t);
+        case PathSearch::Bidirectional: {
+            SearchWorkspace::Lease back;
+            return bidirectionalSearch(*ws, *back, s, t);
+        }
+        case PathSearch::ContractionHierarchy: {
+            SearchWorkspace::Lease back;
+            return hierarchySearch(*ws, *back, s, t);
+        }
+        default:
+            return dijkstraSearch(*ws, s, t);
+    }
+}
+
+void Graph::searchFrom(SearchWorkspace &ws, int s) const {
+    // plain dijkstra from s over the whole graph
+    const CSR &g = adjacency();
+    auto later = greater<SearchWorkspace::HeapItem>();
+    ws.begin(ids.size());
+    chooseQueue(ws);
+    ws.reach(s, 0, -1);
+    ws.pushHeap({0, s}, later);
+    while (!ws.heapEmpty()) {
+        auto [d,u] = ws.popHeap(later);
+        if (d != ws.dist[u]) continue;
+        for (int a = g.offsets[u]; a < g.offsets[u + 1]; a++) {
+            if (!g.open[a]) continue;
+            int v = g.targets[a];
+            int nd = d + g.weights[a];
+            if (nd < ws.distance(v)) {
+                ws.reach(v, nd, u);
+                ws.pushHeap({nd, v}, later);
+            }
+        }
+    }
+}
+
+int Graph::dijkstraSearch(SearchWorkspace &ws, int s, int t) const {
+    const CSR &g = adjacency();
     // min-heap (dist, node)
-    using P = pair<int,int>;
-    priority_queue<P, vector<P>, greater<P>> pq;
+    auto later = greater<SearchWorkspace::HeapItem>();
 
-    for (const auto &kv : adj) dist[kv.first] = INF;
-    dist[src] = 0;
-    pq.push({0, src});
+    ws.begin(ids.size());
+    chooseQueue(ws);
+    ws.reach(s, 0, -1);
+    ws.pushHeap({0, s}, later);
 
-    while (!pq.empty()) {
-        auto [d,u] = pq.top(); pq.pop();
-        if (d != dist[u]) continue;
-        if (u == dst) return d;
-        for (const auto &e : adj.at(u)) {
-            if (!e.open) continue;
-            int nd = d + e.weight;
-            if (nd < dist[e.to]) {
-                dist[e.to] = nd;
-                pq.push({nd, e.to});
+    while (!ws.heapEmpty()) {
+        auto [d,u] = ws.popHeap(later);
+        if (d != ws.dist[u]) continue;
+        ws.countSettled();
+        if (u == t) return d;
+        for (int a = g.offsets[u]; a < g.offsets[u + 1]; a++) {
+            if (!g.open[a]) continue;
+            int v = g.targets[a];
+            int nd = d + g.weights[a];
+            if (nd < ws.distance(v)) {
+                ws.reach(v, nd, u);
+                ws.pushHeap({nd, v}, later);
+            }
+        }
+    }
+
+    return -1;
+}
+
+int Graph::bidirectionalSearch(SearchWorkspace &fw, SearchWorkspace &bw, int s, int t) const {
+    // dijkstra from both ends, always advancing the side with the smaller
+    // frontier key. every arc scanned from a settled vertex into the other
+    // side's reached set is a candidate meeting point; once the two
+    // frontier keys add up to the best candidate nothing shorter is left
+    const CSR &g = adjacency();
+    const int INF = std::numeric_limits<int>::max();
+    auto later = greater<SearchWorkspace::HeapItem>();
+    fw.begin(ids.size());
+    bw.begin(ids.size());
+    fw.reach(s, 0, -1);
+    bw.reach(t, 0, -1);
+    fw.pushHeap({0, s}, later);
+    bw.pushHeap({0, t}, later);
+    int best = s == t ? 0 : INF;
+
+    while (!fw.heap.empty() && !bw.heap.empty()) {
+        if ((long long)fw.heap.front().first + bw.heap.front().first >= best) break;
+        bool forward = fw.heap.front().first <= bw.heap.front().first;
+        SearchWorkspace &side = forward ? fw : bw;
+        SearchWorkspace &other = forward ? bw : fw;
+
+        auto [d,u] = side.popHeap(later);
+        if (d != side.dist[u]) continue;
+        side.countSettled();
+        for (int a = g.offsets[u]; a < g.offsets[u + 1]; a++) {
+            // the backward side walks arcs against their direction
+            if (!g.open[forward ? a : g.reverse[a]]) continue;
+            int v = g.targets[a];
+            int nd = d + g.weights[a];
+            if (nd < side.distance(v)) {
+                side.reach(v, nd, u);
+                side.pushHeap({nd, v}, later);
+            }
+            if (other.reached(v)) best = min(best, nd + other.dist[v]);
+        }
+    }
+
+    return best == INF ? -1 : best;
+}
+
+int Graph::hierarchySearch(SearchWorkspace &fw, SearchWorkspace &bw, int s, int t) const {
+    {
+        lock_guard<recursive_mutex> hold(lazy.m);
+        const CSR &g = adjacency();
+        if (!hierarchy.built()) hierarchy.build(g);
+        if (!hierarchy.customized()) hierarchy.customize(g);
+    }
+    return hierarchy.distance(fw, bw, s, t);
+}
+
+void Graph::setBucketQueueLimit(int maxWeight) {
+    bucketLimit = maxWeight;
+}
+
+void Graph::setPathSearch(PathSearch search) {
+    pathSearch = search;
+}
+
+void Graph::setLandmarkCount(int count) {
+    landmarks.count = count;
+    landmarks.fresh = false;
+}
+
+void Graph::refreshLandmarks() const {
+    // farthest-point selection: each new landmark is the vertex furthest
+    // from all landmarks chosen so far, unreachable ones first, which
+    // spreads them over the edges of the campus and over every component
+    const CSR &g = adjacency();
+    size_t n = ids.size();
+    const int INF = std::numeric_limits<int>::max();
+    auto &lm = landmarks;
+    lm.vertices.clear();
+    lm.dist.clear();
+    lm.fresh = true;
+
+    int start = -1;
+    for (size_t v = 0; v < n && start < 0; v++) {
+        if (g.degree(v) > 0) start = v;
+    }
+    if (start < 0) return;
+
+    SearchWorkspace::Lease ws;
+    vector<int> nearest(n, INF);
+    searchFrom(*ws, start);
+    int pick = start;
+    for (size_t v = 0; v < n; v++) {
+        if (ws->reached(v) && ws->dist[v] > ws->dist[pick]) pick = v;
+    }
+
+    while ((int)lm.vertices.size() < lm.count) {
+        lm.vertices.push_back(pick);
+        searchFrom(*ws, pick);
+        for (size_t v = 0; v < n; v++) {
+            int d = ws->reached(v) ? ws->dist[v] : -1;
+            lm.dist.push_back(d);
+            if (d >= 0) nearest[v] = min(nearest[v], d);
+        }
+
+        pick = -1;
+        for (size_t v = 0; v < n; v++) {
+            if (g.degree(v) == 0 || nearest[v] == 0) continue;
+            if (pick < 0 || nearest[v] > nearest[pick]) pick = v;
+        }
+        if (pick < 0) break;  // every vertex is a landmark
+    }
+}
+
+int Graph::landmarkBound(int v, int t) const {
+    // |d(L, t) - d(L, v)| <= d(v, t) for every landmark L (edges are
+    // undirected). a landmark that reaches exactly one of v and t proves
+    // there is no path at all
+    size_t n = ids.size();
+    int bound = 0;
+    for (size_t i = 0; i < landmarks.vertices.size(); i++) {
+        int lt = landmarks.dist[i * n + t];
+        int lv = landmarks.dist[i * n + v];
+        if (lt < 0 && lv < 0) continue;
+        if (lt < 0 || lv < 0) return -1;
+        bound = max(bound, lt > lv ? lt - lv : lv - lt);
+    }
+    return bound;
+}
+
+int Graph::landmarkSearch(SearchWorkspace &ws, int s, int t) const {
+    // a* with the landmark bounds as potentials; they are consistent, so a
+    // vertex is final the first time it is popped, same as dijkstra
+    const CSR &g = adjacency();
+    {
+        lock_guard<recursive_mutex> hold(lazy.m);
+        if (!landmarks.fresh) refreshLandmarks();
+    }
+    if (landmarkBound(s, t) < 0) return -1;
+
+    auto later = greater<SearchWorkspace::HeapItem>();  // (dist + bound, node)
+    ws.begin(ids.size());
+    ws.reach(s, 0, -1);
+    ws.pushHeap({landmarkBound(s, t), s}, later);
+
+    while (!ws.heap.empty()) {
+        auto [f,u] = ws.popHeap(later);
+        int d = ws.dist[u];
+        if (f != d + landmarkBound(u, t)) continue;
+        ws.countSettled();
+        if (u == t) return d;
+        for (int a = g.offsets[u]; a < g.offsets[u + 1]; a++) {
+            if (!g.open[a]) continue;
+            int v = g.targets[a];
+            int nd = d + g.weights[a];
+            if (nd < ws.distance(v)) {
+                int bound = landmarkBound(v, t);
+                if (bound < 0) continue;
+                ws.reach(v, nd, u);
+                ws.pushHeap({nd + bound, v}, later);
             }
         }
     }
 
-    return (dist[dst] == INF) ? -1 : dist[dst];
+    return -1;
+}
+
+void Graph::settleTargets(SearchWorkspace &ws, int s, const std::vector<int> &targets) const {
+    const CSR &g = adjacency();
+    ws.begin(ids.size());
+
+    // the visited bit marks targets that are still waiting to be settled
+    int pending = 0;
+    for (int id : targets) {
+        int t = vertexIndex(id);
+        if (t >= 0 && !ws.visited(t)) {
+            ws.visit(t);
+            pending++;
+        }
+    }
+
+    // ties settle by location id, as in shortestPathWithRoute, so the parents
+    // left behind describe the same routes
+    using P = SearchWorkspace::HeapItem;
+    auto later = [&](const P &x, const P &y) {
+        if (x.first != y.first) return x.first > y.first;
+        return ids[x.second] > ids[y.second];
+    };
+    ws.reach(s, 0, -1);
+    ws.pushHeap({0, s}, later);
+
+    while (!ws.heapEmpty() && pending > 0) {
+        auto [d,u] = ws.popHeap(later);
+        if (d != ws.dist[u]) continue;
+        if (ws.visited(u)) {
+            ws.unvisit(u);
+            if (--pending == 0) break;
+        }
+        for (int a = g.offsets[u]; a < g.offsets[u + 1]; a++) {
+            if (!g.open[a]) continue;
+            int v = g.targets[a];
+            int nd = d + g.weights[a];
+            if (nd < ws.distance(v)) {
+                ws.reach(v, nd, u);
+                ws.pushHeap({nd, v}, later);
+            }
+        }
+    }
+
+    // whatever is still marked is unreachable
+    for (int id : targets) {
+        int t = vertexIndex(id);
+        if (t >= 0) ws.unvisit(t);
+    }
+}
+
+void Graph::shortestPaths(int src, const std::vector<int> &targets, std::vector<int> &distances) const {
+    distances.assign(targets.size(), -1);
+    int s = vertexIndex(src);
+    if (s < 0) return;
+
+    // when every target has a column, src's entry in each is its distance
+    bool tabled = !targets.empty();
+    for (int id : targets) tabled = tabled && sourceTable.column.count(id);
+    if (tabled) {
+        for (size_t i = 0; i < targets.size(); i++) distances[i] = tableColumn(targets[i])[s];
+        return;
+    }
+
+    if (const int *row = cachedRow(s)) {
+        for (size_t i = 0; i < targets.size(); i++) {
+            int t = vertexIndex(targets[i]);
+            if (t >= 0) distances[i] = row[t];
+        }
+        return;
+    }
+
+    SearchWorkspace::Lease ws;
+    settleTargets(*ws, s, targets);
+    for (size_t i = 0; i < targets.size(); i++) {
+        int t = vertexIndex(targets[i]);
+        if (t >= 0 && ws->reached(t)) distances[i] = ws->dist[t];
+    }
+}
+
+void Graph::shortestPathTree(int src, const std::vector<int> &targets, ShortestPathTree &tree) const {
+    tree.distances.assign(targets.size(), -1);
+    tree.targetNode.assign(targets.size(), -1);
+    tree.nodes.clear();
+    tree.parents.clear();
+    int s = vertexIndex(src);
+    if (s < 0) return;
+
+    SearchWorkspace::Lease ws;
+    settleTargets(*ws, s, targets);
+    for (size_t i = 0; i < targets.size(); i++) {
+        int t = vertexIndex(targets[i]);
+        if (t >= 0 && ws->reached(t)) tree.distances[i] = ws->dist[t];
+    }
+
+    // keep only the branches the routes use. once the distances are copied
+    // out, dist[v] is free to hold v's node index, and the visited bit says
+    // whether v has been added to the tree yet
+    auto addNode = [&](int v, int parentNode) {
+        ws->dist[v] = (int)tree.nodes.size();
+        ws->visit(v);
+        tree.nodes.push_back(ids[v]);
+        tree.parents.push_back(parentNode);
+    };
+    for (size_t i = 0; i < targets.size(); i++) {
+        if (tree.distances[i] < 0) continue;
+        if (tree.nodes.empty()) addNode(s, -1);
+        int t = vertexIndex(targets[i]);
+
+        // climb until the route joins the part already collected, then add
+        // the new stretch top-down so parents come before their children
+        ws->queue.clear();
+        int cur = t;
+        while (!ws->visited(cur)) {
+            ws->enqueue(cur);
+            cur = ws->parent[cur];
+        }
+        int attach = ws->dist[cur];
+        for (size_t k = ws->queue.size(); k-- > 0;) {
+            addNode(ws->queue[k], attach);
+            attach = (int)tree.nodes.size() - 1;
+        }
+        tree.targetNode[i] = ws->dist[t];
+    }
+}
+
+void ShortestPathTree::route(size_t i, std::vector<int> &out) const {
+    out.clear();
+    int depth = 0;
+    for (int n = targetNode[i]; n >= 0; n = parents[n]) depth++;
+    out.resize(depth);
+    for (int n = targetNode[i]; n >= 0; n = parents[n]) out[--depth] = nodes[n];
 }
 
 int Graph::mstCost(const std::unordered_set<int> &vertices) const {
+    return mstCostOf(vertices);
+}
+
+int Graph::mstCost(const std::vector<int> &vertices) const {
+    return mstCostOf(vertices);
+}
+
+template <class Vertices>
+int Graph::mstCostOf(const Vertices &vertices) const {
     if (vertices.empty()) return 0;
-    // Prim's algorithm restricted to `vertices` and only open edges
-    unordered_set<int> V = vertices;
-    // pick a start vertex
-    int start = *V.begin();
-    unordered_set<int> visited;
-    using EdgeItem = pair<int, pair<int,int>>; // weight, (u,v)
-    priority_queue<EdgeItem, vector<EdgeItem>, greater<EdgeItem>> pq;
-
-    visited.insert(start);
-    // push all edges from start that lead to vertices set
-    auto pushEdgesFrom = [&](int u){
-        auto it = adj.find(u);
-        if (it == adj.end()) return;
-        for (const auto &e : it->second) {
-            if (!e.open) continue;
-            if (V.find(e.to) == V.end()) continue;
-            pq.push({e.weight, {u, e.to}});
+    // pick a start vertex; one missing from the graph can never be spanned
+    auto start = index.find(*vertices.begin());
+    if (start == index.end()) return vertices.size() == 1 ? 0 : -1;
+
+    adjacency();
+    SearchWorkspace::Lease ws;
+    ws->begin(ids.size());
+    // a current stamp marks membership in the vertex set. each member also
+    // starts as its own union-find tree of size 1 (parent, dist)
+    for (int id : vertices) {
+        auto it = index.find(id);
+        if (it != index.end()) ws->reach(it->second, 1, it->second);
+    }
+
+    // prim only touches the members' arcs, kruskal scans every edge once;
+    // past an eighth of the campus the scan's lack of a heap wins
+    if (vertices.size() * 8 >= ids.size()) return kruskalCost(*ws, vertices.size());
+    return primCost(*ws, start->second, vertices.size());
+}
+
+int Graph::primCost(SearchWorkspace &ws, int start, size_t members) const {
+    // Prim's algorithm restricted to the members and only open edges
+    const CSR &g = csr;
+    chooseQueue(ws);  // prim's keys are single edge weights, also bounded
+
+    size_t visitedCount = 0;
+    auto later = greater<SearchWorkspace::HeapItem>(); // (weight, v)
+
+    auto visit = [&](int u){
+        ws.visit(u);
+        visitedCount++;
+        // offer every open edge from u to a set vertex not yet in the tree;
+        // the heap keeps the lightest one per vertex
+        for (int a = g.offsets[u]; a < g.offsets[u + 1]; a++) {
+            int v = g.targets[a];
+            if (!g.open[a] || !ws.reached(v) || ws.visited(v)) continue;
+            ws.pushHeap({g.weights[a], v}, later);
         }
     };
 
-    pushEdgesFrom(start);
+    visit(start);
     int total = 0;
-    while (!pq.empty() && visited.size() < V.size()) {
-        auto item = pq.top(); pq.pop();
-        int w = item.first;
-        int v = item.second.second;
-        if (visited.find(v) != visited.end()) continue;
-        // add v
-        visited.insert(v);
+    while (!ws.heapEmpty() && visitedCount < members) {
+        auto [w, v] = ws.popHeap(later);
+        if (ws.visited(v)) continue;
         total += w;
-        pushEdgesFrom(v);
+        visit(v);
     }
 
-    if (visited.size() != V.size()) {
+    if (visitedCount != members) {
         // graph not fully connected within vertices (shouldn't happen for tested cases)
         return -1;
     }
     return total;
 }
 
+int Graph::kruskalCost(SearchWorkspace &ws, size_t members) const {
+    // edges are only ever appended, so a size mismatch means new ones
+    {
+        lock_guard<recursive_mutex> hold(lazy.m);
+        if (edgesByWeight.size() != edges.size()) {
+            edgesByWeight.resize(edges.size());
+            for (int e = 0; e < (int)edges.size(); e++) edgesByWeight[e] = e;
+            stable_sort(edgesByWeight.begin(), edgesByWeight.end(), [&](int x, int y) {
+                return edges[x].weight < edges[y].weight;
+            });
+        }
+    }
+
+    auto find = [&](int v) {
+        while (ws.parent[v] != v) {
+            ws.parent[v] = ws.parent[ws.parent[v]];  // path halving
+            v = ws.parent[v];
+        }
+        return v;
+    };
+
+    size_t joined = 1;
+    int total = 0;
+    for (int e : edgesByWeight) {
+        if (joined == members) break;
+        const auto &r = edges[e];
+        if (!r.open || !ws.reached(r.u) || !ws.reached(r.v)) continue;
+        int a = find(r.u);
+        int b = find(r.v);
+        if (a == b) continue;
+        if (ws.dist[a] < ws.dist[b]) swap(a, b);
+        ws.parent[b] = a;
+        ws.dist[a] += ws.dist[b];
+        total += r.weight;
+        joined++;
+    }
+    return joined == members ? total : -1;
+}
+
 int Graph::shortestPathWithRoute(int src, int dst, std::vector<int>& route) const {
     route.clear();
-    if (adj.find(src) == adj.end() || adj.find(dst) == adj.end()) return -1;
-    
-    const int INF = std::numeric_limits<int>::max();
-    unordered_map<int, int> dist;
-    unordered_map<int, int> parent;
-    using P = pair<int,int>;
-    priority_queue<P, vector<P>, greater<P>> pq;
+    int s = vertexIndex(src);
+    int t = vertexIndex(dst);
+    if (s < 0 || t < 0) return -1;
+
+    const CSR &g = adjacency();
+    SearchWorkspace::Lease ws;
+    // min-heap on (dist, location id) so ties settle in the same order as
+    // before the dense remapping, which keeps the chosen routes identical
+    using P = SearchWorkspace::HeapItem;
+    auto later = [&](const P &x, const P &y) {
+        if (x.first != y.first) return x.first > y.first;
+        return ids[x.second] > ids[y.second];
+    };
 
-    for (const auto &kv : adj) dist[kv.first] = INF;
-    dist[src] = 0;
-    pq.push({0, src});
+    ws->begin(ids.size());
+    ws->reach(s, 0, -1);
+    ws->pushHeap({0, s}, later);
 
-    while (!pq.empty()) {
-        auto [d,u] = pq.top(); pq.pop();
-        if (d != dist[u]) continue;
-        if (u == dst) break;
-        for (const auto &e : adj.at(u)) {
-            if (!e.open) continue;
-            int nd = d + e.weight;
-            if (nd < dist[e.to]) {
-                dist[e.to] = nd;
-                parent[e.to] = u;
-                pq.push({nd, e.to});
+    while (!ws->heapEmpty()) {
+        auto [d,u] = ws->popHeap(later);
+        if (d != ws->dist[u]) continue;
+        if (u == t) break;
+        for (int a = g.offsets[u]; a < g.offsets[u + 1]; a++) {
+            if (!g.open[a]) continue;
+            int v = g.targets[a];
+            int nd = d + g.weights[a];
+            if (nd < ws->distance(v)) {
+                ws->reach(v, nd, u);
+                ws->pushHeap({nd, v}, later);
             }
         }
     }
 
-    if (dist[dst] == INF) return -1;
-    
+    if (!ws->reached(t)) return -1;
+
     // Reconstruct path
-    int cur = dst;
-    while (cur != src) {
-        route.push_back(cur);
-        cur = parent[cur];
+    int cur = t;
+    while (cur != s) {
+        route.push_back(ids[cur]);
+        cur = ws->parent[cur];
     }
     route.push_back(src);
     reverse(route.begin(), route.end());
-    
-    return dist[dst];
+
+    return ws->dist[t];
 }
@@ -2,32 +2,279 @@
 #include <unordered_map>
 #include <vector>
 #include <string>
+#include <string_view>
 #include <unordered_set>
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+#include "ContractionHierarchy.h"
 
-struct Edge {
-    int to;
-    int weight;
-    bool open;
+// compressed sparse row adjacency over dense vertex indices.
+// the arcs leaving vertex u are [offsets[u], offsets[u + 1]) in the arc arrays,
+// kept in the order the edges were added.
+struct CSR {
+    std::vector<int> offsets;
+    std::vector<int> targets;
+    std::vector<int> weights;
+    std::vector<char> open;  // mirrors the edge's flag; char so arcs are plain bytes
+    std::vector<int> edge;   // undirected edge (index into Graph::edges) of each arc
+    std::vector<int> reverse; // the same edge's arc in the other direction
+    std::vector<int> arcOf;  // per edge, its arc leaving the edge's u endpoint
+    int minWeight = 0;       // over all edges, open or not
+    int maxWeight = 0;
+
+    int degree(int u) const { return offsets[u + 1] - offsets[u]; }
+};
+
+class SearchWorkspace;
+class SnapshotWriter;
+class SnapshotReader;
+
+// routes from one source to several targets, kept as the part of the
+// shortest-path tree those routes use. filled by Graph::shortestPathTree
+class ShortestPathTree {
+public:
+    size_t size() const { return distances.size(); }
+    int distance(size_t i) const { return distances[i]; }
+    // location ids from the source to target i, empty if it is unreachable
+    void route(size_t i, std::vector<int>& out) const;
+    // every location on any of the routes, each listed once
+    const std::vector<int>& vertices() const { return nodes; }
+
+private:
+    friend class Graph;
+    std::vector<int> distances;   // per target, -1 when unreachable
+    std::vector<int> targetNode;  // per target, index into nodes or -1
+    std::vector<int> nodes;       // location ids, parents before children
+    std::vector<int> parents;     // index into nodes, -1 for the source
 };
 
+// how Graph::shortestPath searches when the distance cache does not answer
+enum class PathSearch {
+    Dijkstra,
+    Landmarks,  // A* with ALT (landmark + triangle inequality) lower bounds
+    Bidirectional,  // dijkstra from both ends until the searches meet
+    ContractionHierarchy,  // upward searches over a customizable hierarchy
+};
+
+// const queries may share a Graph across threads. the adjacency arrays,
+// distance cache, component labels, landmarks, hierarchy and distance table
+// are built or brought up to date lazily by whichever query needs them
+// first, under a lock; the searches themselves run unlocked, each thread on
+// workspaces from its own pool. calls that change the graph (adding,
+// toggling, loading, settings) need it to themselves
 class Graph {
 private:
-    std::unordered_map<int, std::vector<Edge>> adj;
+    struct EdgeRecord {
+        int u;
+        int v;
+        int weight;
+        bool open;  // shared by both directions
+        uint64_t changed;  // graph version that added or last toggled it
+    };
+
+    // location ids are translated to dense indices once, at the API boundary
+    std::unordered_map<int, int> index;
+    std::vector<int> ids;
+    std::vector<EdgeRecord> edges;
+    // unordered location pair -> first edge added between them, which is the
+    // one toggleEdge and edgeStatus act on
+    std::unordered_map<uint64_t, int> edgeIndex;
     std::unordered_map<int, std::string> names;
+    // bumped by every change to locations, edges or edge states
+    uint64_t changes = 0;
+    // last version that added a location or an edge
+    uint64_t structureChanged = 0;
+    // (version, edge) for every toggle after historyStart, oldest first
+    std::vector<std::pair<uint64_t,int>> flipLog;
+    uint64_t historyStart = 0;
+
+    // rebuilt lazily after addLocation/addEdge
+    mutable CSR csr;
+    mutable bool csrDirty = false;
+
+    // optional all-pairs distances (-1 when unreachable), one row per source
+    // filled on demand, together with the shortest-path tree (parent of each
+    // vertex) that produced the row so toggles can repair it in place.
+    // only used while both n * n int matrices fit in budgetBytes
+    struct DistanceCache {
+        size_t budgetBytes = 0;
+        size_t n = 0;
+        std::vector<int> matrix;
+        std::vector<int> parents;
+        std::vector<char> rowReady;
+
+        void reset() { n = 0; matrix.clear(); parents.clear(); rowReady.clear(); }
+    };
+    mutable DistanceCache distCache;
+
+    // connected components over open edges, so isConnected is a label
+    // comparison. a clean label covers exactly one component. closing an
+    // edge only marks its component dirty; it is relabelled lazily from
+    // whichever of its vertices is queried next
+    struct ComponentIndex {
+        bool built = false;
+        std::vector<int> label;   // per vertex
+        std::vector<int> size;    // per label
+        std::vector<char> dirty;  // per label
+
+        void reset() { built = false; label.clear(); size.clear(); dirty.clear(); }
+    };
+    mutable ComponentIndex components;
+
+    PathSearch pathSearch = PathSearch::Dijkstra;
+    // searches switch to a bucket queue while every weight is in
+    // [0, bucketLimit]; never when it is 0 or less
+    int bucketLimit = 255;
+
+    // exact distances from a few spread-out landmark vertices, giving A*
+    // lower bounds. closures leave them valid; reopening an edge or
+    // changing the graph marks them stale and they are recomputed on the
+    // next landmark search
+    struct LandmarkTable {
+        int count = 8;
+        bool fresh = false;
+        std::vector<int> vertices;
+        std::vector<int> dist;  // one row of n per landmark, -1 unreachable
+    };
+    mutable LandmarkTable landmarks;
+
+    // the ordering is built on first use and kept until the graph itself
+    // changes; a toggle redoes only the shortcut weights above its edges
+    mutable ContractionHierarchy hierarchy;
+
+    // distances from a few fixed sources to every vertex, one column of n
+    // per source (-1 unreachable). a column remembers the graph version it
+    // was computed at and is recomputed the first time it is read after that
+    struct SourceTable {
+        size_t n = 0;
+        std::unordered_map<int, int> column;  // source location id -> column
+        std::vector<int> sources;             // location id per column
+        std::vector<uint64_t> version;
+        std::vector<int> dist;
+    };
+    mutable SourceTable sourceTable;
+
+    // every edge index ordered by weight, for kruskal. re-sorted only after
+    // edges are added
+    mutable std::vector<int> edgesByWeight;
+
+    // held while a const query fills in any of the lazy state above. state
+    // filled for the current graph is never touched again until it changes,
+    // so a query can read it after letting go. recursive because the
+    // rebuilds nest (most need the adjacency arrays); a copied Graph gets a
+    // lock of its own
+    struct LazyLock {
+        std::recursive_mutex m;
+        LazyLock() = default;
+        LazyLock(const LazyLock &) {}
+        LazyLock &operator=(const LazyLock &) { return *this; }
+    };
+    mutable LazyLock lazy;
+
+    int internVertex(int id);
+    int vertexIndex(int id) const;
+    const CSR& adjacency() const;
+    void buildCSR() const;
+    void chooseQueue(SearchWorkspace& ws) const;
+    int findEdge(int a, int b) const;
+    void flipEdges(const int* changed, size_t count);
+    const int* cachedRow(int s) const;
+    void assignTableSources(const std::vector<int>& sources);
+    const int* tableColumn(int id) const;
+    bool columnStillExact(const int* col, uint64_t since) const;
+    template <class F>
+    bool forEachToggledSince(uint64_t since, F visit) const;
+    void repairCachedRows(const int* changed, size_t count);
+    void repairRow(SearchWorkspace& ws, int* dist, int* parent, const int* changed, size_t count);
+    int componentOf(int v) const;
+    void labelComponent(SearchWorkspace& ws, int v) const;
+    void updateComponents(const int* changed, size_t count);
+    void searchFrom(SearchWorkspace& ws, int s) const;
+    int dijkstraSearch(SearchWorkspace& ws, int s, int t) const;
+    void refreshLandmarks() const;
+    int landmarkBound(int v, int t) const;
+    int landmarkSearch(SearchWorkspace& ws, int s, int t) const;
+    int bidirectionalSearch(SearchWorkspace& fw, SearchWorkspace& bw, int s, int t) const;
+    int hierarchySearch(SearchWorkspace& fw, SearchWorkspace& bw, int s, int t) const;
+    void settleTargets(SearchWorkspace& ws, int s, const std::vector<int>& targets) const;
+    template <class Vertices>
+    int mstCostOf(const Vertices& vertices) const;
+    int primCost(SearchWorkspace& ws, int start, size_t members) const;
+    int kruskalCost(SearchWorkspace& ws, size_t members) const;
 
 public:
     Graph() = default;
 
-    void addLocation(int id, const std::string& name);
+    // room for this many locations and edges, so a bulk load does not rehash
+    void reserve(size_t locations, size_t edgeCount);
+    void addLocation(int id, std::string_view name);
     void addEdge(int a, int b, int weight);
 
     void toggleEdge(int a, int b);
+    // toggle every pair in one go. pairs toggled an even number of times
+    // cancel out, and caches are brought up to date once at the end
+    void toggleEdges(const std::vector<std::pair<int,int>>& pairs);
     std::string edgeStatus(int a, int b) const;
+    // changes whenever anything a query could observe changes, so results
+    // computed at one version stay valid while it holds
+    uint64_t version() const { return changes; }
+    // version that added the edge between a and b or last toggled it, 0 if
+    // there is none
+    uint64_t edgeVersion(int a, int b) const;
+    // location pairs of the edges toggled after version `since`, each once.
+    // false when that history is unavailable (locations or edges were added
+    // since, or it is too old); anything computed at `since` must then be
+    // recomputed. otherwise results that do not involve these edges still hold
+    bool toggledSince(uint64_t since, std::vector<std::pair<int,int>>& pairs) const;
 
     bool isConnected(int a, int b) const;
     int shortestPath(int src, int dst) const;
+    // distances from src to each of targets (-1 when unreachable) from a
+    // single search that stops once every target is settled
+    void shortestPaths(int src, const std::vector<int>& targets, std::vector<int>& distances) const;
+    // same search, but also keeps the routes to every target
+    void shortestPathTree(int src, const std::vector<int>& targets, ShortestPathTree& tree) const;
+
+    // answer shortestPath/shortestPaths from an all-pairs distance matrix
+    // whenever it fits in budgetBytes (two V * V int matrices, distances and
+    // parents); 0 turns the cache off. rows are computed the first time their
+    // source is asked for and repaired incrementally when an edge is toggled.
+    // not safe for concurrent queries while active
+    void setDistanceCacheBudget(size_t budgetBytes);
+    bool distanceCacheActive() const;
+
+    // distance and cost searches (dijkstra, prim) use a Dial bucket queue
+    // instead of a binary heap while every edge weight is an integer in
+    // [0, maxWeight]. searches for printed routes keep the heap, so ties
+    // still break by id. 0 or less always keeps the binary heap
+    void setBucketQueueLimit(int maxWeight);
+
+    // keep a distance column for each of these locations (the class
+    // locations, say), all computed now. shortestPath and shortestPaths
+    // answer from the columns whenever the other end of the query has one;
+    // after a toggle or a new edge a column is brought up to date the next
+    // time it is read
+    void setDistanceTableSources(const std::vector<int>& sources);
+    // every column is up to date with the graph, so reading one runs no search
+    bool distanceTableReady() const;
+
+    // locations, names, edges with their states, the adjacency arrays and
+    // the distance table sources, plus every table column when
+    // withDistanceTables (computing any that are missing)
+    void writeSnapshot(SnapshotWriter& out, bool withDistanceTables) const;
+    // the reverse of writeSnapshot, into a graph with no locations yet. false,
+    // leaving the graph untouched, if it is not empty or the data does not
+    // describe a consistent graph
+    bool readSnapshot(SnapshotReader& in);
+
+    void setPathSearch(PathSearch search);
+    // number of landmarks used by PathSearch::Landmarks
+    void setLandmarkCount(int count);
 
     int mstCost(const std::unordered_set<int>& vertices) const;
+    // same, for a list of distinct location ids
+    int mstCost(const std::vector<int>& vertices) const;
 
     const std::string& getLocationName(int id) const { return names.at(id); }
     bool hasLocation(int id) const { return names.find(id) != names.end(); }
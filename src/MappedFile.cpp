@@ -0,0 +1,57 @@
+#include "MappedFile.h"
+#include <fstream>
+#include <sstream>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+bool MappedFile::open(const std::string &path) {
+    close();
+#ifndef _WIN32
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat info;
+    if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode)) {
+        length = (size_t)info.st_size;
+        if (length == 0) {
+            ::close(fd);
+            return true;
+        }
+        void *p = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (p != MAP_FAILED) {
+            madvise(p, length, MADV_SEQUENTIAL);
+            bytes = static_cast<const char *>(p);
+            mapped = true;
+            return true;
+        }
+        length = 0;
+    } else {
+        ::close(fd);
+    }
+#endif
+    // not mappable (a pipe, say): read it all instead
+    ifstream in(path, ios::binary);
+    if (!in.is_open()) return false;
+    ostringstream contents;
+    contents << in.rdbuf();
+    copy = contents.str();
+    bytes = copy.data();
+    length = copy.size();
+    return true;
+}
+
+void MappedFile::close() {
+#ifndef _WIN32
+    if (mapped) munmap(const_cast<char *>(bytes), length);
+#endif
+    mapped = false;
+    bytes = nullptr;
+    length = 0;
+    copy.clear();
+}
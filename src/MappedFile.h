@@ -0,0 +1,25 @@
+#pragma once
+#include <string>
+#include <string_view>
+
+// read-only view of a whole file. memory mapped where the platform has
+// mmap, read into memory otherwise
+class MappedFile {
+private:
+    const char* bytes = nullptr;
+    size_t length = 0;
+    bool mapped = false;
+    std::string copy;  // the contents when not mapped
+
+public:
+    MappedFile() = default;
+    ~MappedFile() { close(); }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // false if the file cannot be opened or read
+    bool open(const std::string& path);
+    void close();
+
+    std::string_view view() const { return {bytes, length}; }
+};
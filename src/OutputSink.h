@@ -0,0 +1,48 @@
+#pragma once
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <charconv>
+
+// collects command output in one buffer and hands it to a stream in large
+// writes: whenever the buffer passes its limit, on flush(), and when the
+// sink goes away. nothing is flushed per line
+class OutputSink {
+private:
+    std::ostream* out;
+    std::string buffer;
+    size_t limit;
+
+public:
+    explicit OutputSink(std::ostream& out, size_t limit = 1 << 16) : out(&out), limit(limit) {
+        buffer.reserve(limit + 256);
+    }
+    ~OutputSink() { flush(); }
+    OutputSink(const OutputSink&) = delete;
+    OutputSink& operator=(const OutputSink&) = delete;
+
+    OutputSink& operator<<(std::string_view s) {
+        buffer.append(s.data(), s.size());
+        if (buffer.size() >= limit) flush();
+        return *this;
+    }
+
+    OutputSink& operator<<(char c) {
+        buffer.push_back(c);
+        if (buffer.size() >= limit) flush();
+        return *this;
+    }
+
+    OutputSink& operator<<(int value) {
+        char digits[16];
+        auto end = std::to_chars(digits, digits + sizeof(digits), value).ptr;
+        return *this << std::string_view(digits, end - digits);
+    }
+
+    void flush() {
+        if (buffer.empty()) return;
+        out->write(buffer.data(), (std::streamsize)buffer.size());
+        out->flush();
+        buffer.clear();
+    }
+};
@@ -0,0 +1,96 @@
+#include "SearchWorkspace.h"
+#include <atomic>
+#include <limits>
+
+using namespace std;
+
+namespace {
+    atomic<size_t> allocations{0};
+    thread_local size_t settled = 0;
+
+    // idle workspaces of the current thread. nested queries each take their
+    // own, so a thread ends up holding as many as its deepest nesting
+    vector<unique_ptr<SearchWorkspace>>& threadPool() {
+        thread_local vector<unique_ptr<SearchWorkspace>> pool;
+        return pool;
+    }
+}
+
+SearchWorkspace::Lease::Lease() {
+    auto &pool = threadPool();
+    if (pool.empty()) {
+        countAllocation();
+        ws = make_unique<SearchWorkspace>();
+    } else {
+        ws = move(pool.back());
+        pool.pop_back();
+    }
+}
+
+SearchWorkspace::Lease::~Lease() {
+    auto &pool = threadPool();
+    grow(pool);
+    pool.push_back(move(ws));
+}
+
+void SearchWorkspace::begin(size_t n) {
+    if (stamp.size() < n) {
+        countAllocation();
+        dist.resize(n);
+        parent.resize(n);
+        stamp.resize(n, 0);
+    }
+    // a search that stopped early leaves vertices queued
+    for (const auto &item : heap) heapSlot[item.second] = -1;
+    if (heapSlot.size() < n) {
+        countAllocation();
+        heapSlot.resize(n, -1);
+    }
+    if (++generation == 0) {
+        // stamps wrapped around, old ones could look current again
+        fill(stamp.begin(), stamp.end(), 0);
+        generation = 1;
+    }
+
+    size_t words = (n + 63) / 64;
+    if (visitedBits.size() < words) {
+        countAllocation();
+        visitedBits.resize(words);
+    }
+    fill(visitedBits.begin(), visitedBits.begin() + words, 0);
+    queue.clear();
+    heap.clear();
+    bucketRing = 0;
+}
+
+void SearchWorkspace::useBuckets(int width) {
+    bucketRing = (size_t)width + 1;
+    if (buckets.size() < bucketRing) {
+        countAllocation();
+        buckets.resize(bucketRing);
+    }
+    // an earlier search may have stopped with items still queued
+    for (size_t i = 0; i < bucketRing; i++) buckets[i].clear();
+    bucketCount = 0;
+    bucketCursor = 0;
+}
+
+int SearchWorkspace::distance(int v) const {
+    return reached(v) ? dist[v] : numeric_limits<int>::max();
+}
+
+size_t SearchWorkspace::allocationCount() {
+    return allocations.load(memory_order_relaxed);
+}
+
+void SearchWorkspace::countAllocation() {
+    allocations.fetch_add(1, memory_order_relaxed);
+}
+
+size_t SearchWorkspace::settledCount() {
+    return settled;
+}
+
+void SearchWorkspace::countSettled() {
+    settled++;
+}
@@ -0,0 +1,179 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+
+// scratch storage for one graph query: generation stamped distance/parent
+// arrays, a visited bitset, a vertex queue and a priority queue.
+// queries borrow a workspace from a per-thread pool through a Lease and give
+// it back when done, so once the buffers have grown to the graph size a
+// query does not touch the allocator at all.
+class SearchWorkspace {
+public:
+    using HeapItem = std::pair<int,int>;
+
+    class Lease {
+    public:
+        Lease();
+        ~Lease();
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+
+        SearchWorkspace& operator*() const { return *ws; }
+        SearchWorkspace* operator->() const { return ws.get(); }
+
+    private:
+        std::unique_ptr<SearchWorkspace> ws;
+    };
+
+    // a slot of dist/parent only counts when its stamp matches the current
+    // generation, so those arrays are never re-cleared between searches
+    std::vector<int> dist;
+    std::vector<int> parent;
+    std::vector<unsigned> stamp;
+    unsigned generation = 0;
+
+    std::vector<uint64_t> visitedBits;
+    std::vector<int> queue;
+    // indexed 4-ary heap of (key, vertex): a vertex is queued at most once,
+    // so the heap never holds more than n items. heap.front() is the minimum
+    std::vector<HeapItem> heap;
+
+    // start a new search over n vertices
+    void begin(size_t n);
+
+    bool reached(int v) const { return stamp[v] == generation; }
+    int distance(int v) const;
+    void reach(int v, int d, int p) { stamp[v] = generation; dist[v] = d; parent[v] = p; }
+
+    bool visited(int v) const { return (visitedBits[v >> 6] >> (v & 63)) & 1; }
+    void visit(int v) { visitedBits[v >> 6] |= uint64_t(1) << (v & 63); }
+    void unvisit(int v) { visitedBits[v >> 6] &= ~(uint64_t(1) << (v & 63)); }
+
+    void enqueue(int v) { grow(queue); queue.push_back(v); }
+
+    // switch this search's priority queue from the heap to a Dial bucket
+    // queue: a ring of width + 1 buckets indexed by key. valid while every
+    // queued key is within width of the smallest one, which holds for
+    // dijkstra and prim when edge weights are in [0, width]. pushes and pops
+    // are O(1), but items with equal keys pop in no particular order, so
+    // searches whose output depends on how ties break keep the heap
+    void useBuckets(int width);
+
+    // the priority queue, min first under cmp (a "greater" comparison; the
+    // bucket queue only looks at keys). pushing a vertex that is already
+    // queued lowers its key instead, and is ignored if the new key is not
+    // smaller. the bucket queue keeps lazy duplicates, so callers still skip
+    // items whose key is out of date
+    template <class Compare>
+    void pushHeap(HeapItem item, Compare cmp);
+    template <class Compare>
+    HeapItem popHeap(Compare cmp);
+    bool heapEmpty() const { return bucketRing ? bucketCount == 0 : heap.empty(); }
+
+    // how many times any workspace (or the pools holding them) had to allocate.
+    // stays flat once queries reach a steady state
+    static size_t allocationCount();
+
+    // vertices settled by point-to-point searches on this thread so far
+    static size_t settledCount();
+    static void countSettled();
+
+private:
+    std::vector<int> heapSlot;  // per vertex, its position in heap or -1
+    std::vector<std::vector<HeapItem>> buckets;
+    size_t bucketRing = 0;  // 0 while the binary heap is in use
+    size_t bucketCount = 0;
+    int bucketCursor = 0;   // no queued key is smaller
+
+    template <class Compare>
+    void siftUp(size_t i, Compare cmp);
+    template <class Compare>
+    void siftDown(size_t i, Compare cmp);
+
+    template <class T>
+    static void grow(std::vector<T>& v);
+    static void countAllocation();
+};
+
+template <class T>
+void SearchWorkspace::grow(std::vector<T>& v) {
+    if (v.size() == v.capacity()) countAllocation();
+}
+
+template <class Compare>
+void SearchWorkspace::pushHeap(HeapItem item, Compare cmp) {
+    if (bucketRing) {
+        if (bucketCount == 0 || item.first < bucketCursor) bucketCursor = item.first;
+        auto &bucket = buckets[item.first % bucketRing];
+        grow(bucket);
+        bucket.push_back(item);
+        bucketCount++;
+        return;
+    }
+    int slot = heapSlot[item.second];
+    if (slot >= 0) {
+        if (!cmp(heap[slot], item)) return;
+        heap[slot] = item;
+        siftUp(slot, cmp);
+        return;
+    }
+    grow(heap);
+    heap.push_back(item);
+    siftUp(heap.size() - 1, cmp);
+}
+
+template <class Compare>
+SearchWorkspace::HeapItem SearchWorkspace::popHeap(Compare cmp) {
+    if (bucketRing) {
+        while (buckets[bucketCursor % bucketRing].empty()) bucketCursor++;
+        auto &bucket = buckets[bucketCursor % bucketRing];
+        HeapItem top = bucket.back();
+        bucket.pop_back();
+        bucketCount--;
+        return top;
+    }
+    HeapItem top = heap.front();
+    heapSlot[top.second] = -1;
+    heap.front() = heap.back();
+    heap.pop_back();
+    if (!heap.empty()) siftDown(0, cmp);
+    return top;
+}
+
+template <class Compare>
+void SearchWorkspace::siftUp(size_t i, Compare cmp) {
+    HeapItem item = heap[i];
+    while (i > 0) {
+        size_t up = (i - 1) / 4;
+        if (!cmp(heap[up], item)) break;
+        heap[i] = heap[up];
+        heapSlot[heap[i].second] = (int)i;
+        i = up;
+    }
+    heap[i] = item;
+    heapSlot[item.second] = (int)i;
+}
+
+template <class Compare>
+void SearchWorkspace::siftDown(size_t i, Compare cmp) {
+    HeapItem item = heap[i];
+    size_t n = heap.size();
+    while (true) {
+        size_t first = 4 * i + 1;
+        if (first >= n) break;
+        size_t best = first;
+        for (size_t c = first + 1; c < std::min(first + 4, n); c++) {
+            if (cmp(heap[best], heap[c])) best = c;
+        }
+        if (!cmp(item, heap[best])) break;
+        heap[i] = heap[best];
+        heapSlot[heap[i].second] = (int)i;
+        i = best;
+    }
+    heap[i] = item;
+    heapSlot[item.second] = (int)i;
+}
@@ -0,0 +1,125 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// the pieces of a binary snapshot: plain values and arrays of them in the
+// machine's own byte order, strings and arrays prefixed by their length.
+// a snapshot is only read back on the kind of machine that wrote it; the
+// header's magic number catches a foreign byte order
+class SnapshotWriter {
+private:
+    std::string bytes;
+
+public:
+    template <class T>
+    void put(const T& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "plain values only");
+        bytes.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template <class T>
+    void putArray(const T* values, size_t count) {
+        static_assert(std::is_trivially_copyable<T>::value, "plain values only");
+        put<uint64_t>(count);
+        bytes.append(reinterpret_cast<const char*>(values), count * sizeof(T));
+    }
+
+    template <class T>
+    void putArray(const std::vector<T>& values) {
+        putArray(values.data(), values.size());
+    }
+
+    void putString(std::string_view text) {
+        put<uint64_t>(text.size());
+        bytes.append(text.data(), text.size());
+    }
+
+    const std::string& data() const { return bytes; }
+    std::string& data() { return bytes; }
+};
+
+// reads back what a SnapshotWriter wrote, from a view of the file. a read
+// past the end fails, and once one read fails every later one does too,
+// giving 0 or empty
+class SnapshotReader {
+private:
+    std::string_view rest;
+    bool fail = false;
+
+    bool take(void* out, size_t size) {
+        if (fail || rest.size() < size) {
+            fail = true;
+            return false;
+        }
+        if (size) std::memcpy(out, rest.data(), size);
+        rest.remove_prefix(size);
+        return true;
+    }
+
+    // an array length, failing when the rest could not hold that many items
+    bool length(uint64_t& count, size_t itemSize) {
+        if (!take(&count, sizeof(count))) return false;
+        if (count > rest.size() / itemSize) {
+            fail = true;
+            return false;
+        }
+        return true;
+    }
+
+public:
+    explicit SnapshotReader(std::string_view bytes) : rest(bytes) {}
+
+    bool failed() const { return fail; }
+    size_t remaining() const { return rest.size(); }
+    std::string_view unread() const { return rest; }
+
+    template <class T>
+    T get() {
+        static_assert(std::is_trivially_copyable<T>::value, "plain values only");
+        T value{};
+        if (!take(&value, sizeof(T))) return T{};
+        return value;
+    }
+
+    template <class T>
+    void getArray(std::vector<T>& values) {
+        static_assert(std::is_trivially_copyable<T>::value, "plain values only");
+        uint64_t count = 0;
+        if (!length(count, sizeof(T))) {
+            values.clear();
+            return;
+        }
+        values.resize(count);
+        take(values.data(), count * sizeof(T));
+    }
+
+    std::string_view getString() {
+        uint64_t count = 0;
+        if (!length(count, 1)) return {};
+        std::string_view text = rest.substr(0, count);
+        rest.remove_prefix(count);
+        return text;
+    }
+};
+
+// fnv-1a over 8-byte words, then the odd bytes at the end. catches a torn
+// or damaged file, not tampering
+inline uint64_t snapshotChecksum(std::string_view bytes) {
+    uint64_t hash = 1469598103934665603ull;
+    size_t i = 0;
+    for (; i + 8 <= bytes.size(); i += 8) {
+        uint64_t word;
+        std::memcpy(&word, bytes.data() + i, 8);
+        hash ^= word;
+        hash *= 1099511628211ull;
+    }
+    for (; i < bytes.size(); i++) {
+        hash ^= (unsigned char)bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
@@ -43,6 +43,10 @@ private:
     }
 
 public:
+    void reserveClasses(size_t count) {
+        classCatalog.reserve(count);
+    }
+
     void addClassInfo(const std::string& code, int locationId, int startMinutes, int endMinutes) {
         classCatalog[code] = {locationId, startMinutes, endMinutes};
     }
@@ -56,6 +60,19 @@ public:
         return (it != classCatalog.end()) ? &it->second : nullptr;
     }
 
+    const std::unordered_map<std::string, ClassInfo>& getClassCatalog() const {
+        return classCatalog;
+    }
+
+    // every location that hosts a class, each listed once
+    std::vector<int> getClassLocations() const {
+        std::vector<int> locations;
+        for (const auto& [code, info] : classCatalog) locations.push_back(info.locationId);
+        std::sort(locations.begin(), locations.end());
+        locations.erase(std::unique(locations.begin(), locations.end()), locations.end());
+        return locations;
+    }
+
     bool insertStudent(const std::string& name, const std::string& id, int residenceId, const std::vector<std::string>& classCodes) {
         if (!isValidName(name) || !isValidId(id)) return false;
         if (students.find(id) != students.end()) return false;
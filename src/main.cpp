@@ -1,26 +1,69 @@
-#include <iostream>
-
-#include "CampusCompass.h"
-
-using namespace std;
-
-int main() {
-    CampusCompass compass;
-
-    // Try multiple possible paths for data files
-    if (!compass.ParseCSV("data/edges.csv", "data/classes.csv")) {
-        if (!compass.ParseCSV("../data/edges.csv", "../data/classes.csv")) {
-            compass.ParseCSV("./data/edges.csv", "./data/classes.csv");
-        }
-    }
-
-    string command;
-    getline(cin, command);
-    int num_of_lines = stoi(command);
-    for(int i = 0; i < num_of_lines; i++){
-        // Parse commands
-        getline(cin, command);
-        compass.ParseCommand(command);
-    }
-
-}
+#include <iostream>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#include "CampusCompass.h"
+#include "CommandBatch.h"
+
+using namespace std;
+
+// Main --batch FILE replays a command log (one command per line, the count
+// line optional) from a memory mapped file; FILE "-" reads stdin in large
+// chunks. throughput goes to stderr when done
+static int runBatch(CampusCompass &compass, const char *path) {
+    CommandBatch batch(compass);
+    auto start = chrono::steady_clock::now();
+    if (strcmp(path, "-") == 0) {
+        batch.runStream(stdin);
+    } else if (!batch.runFile(path)) {
+        cerr << "cannot read " << path << endl;
+        return 1;
+    }
+    compass.flushOutput();
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cerr << batch.commands() << " commands in " << seconds << " s ("
+         << (seconds > 0 ? batch.commands() / seconds : 0) << " commands/sec)" << endl;
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    // results are written through CampusCompass's own buffer, so the C
+    // stdio streams never need to be kept in step
+    ios::sync_with_stdio(false);
+    cin.tie(nullptr);
+
+    // --batch FILE as above; --snapshot FILE starts from a binary snapshot
+    // of the csv data, rewriting it whenever the csv files have changed
+    const char *batchPath = nullptr;
+    const char *snapshotPath = nullptr;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--batch") == 0) batchPath = argv[i + 1];
+        else if (strcmp(argv[i], "--snapshot") == 0) snapshotPath = argv[i + 1];
+    }
+
+    CampusCompass compass;
+    auto load = [&](const string &dir) {
+        if (snapshotPath) return compass.LoadCampus(dir + "edges.csv", dir + "classes.csv", snapshotPath);
+        return compass.ParseCSV(dir + "edges.csv", dir + "classes.csv");
+    };
+
+    // Try multiple possible paths for data files
+    if (!load("data/")) {
+        if (!load("../data/")) {
+            load("./data/");
+        }
+    }
+
+    if (batchPath) return runBatch(compass, batchPath);
+
+    string command;
+    getline(cin, command);
+    int num_of_lines = stoi(command);
+    for(int i = 0; i < num_of_lines; i++){
+        // Parse commands
+        getline(cin, command);
+        compass.ParseCommand(command);
+    }
+
+}
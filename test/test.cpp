@@ -342,3 +342,1100 @@ TEST_CASE("campuscompass insert and remove student via parsecommand", "[integrat
 
 
 */
+#include <catch2/catch_test_macros.hpp>
+#include "../src/Graph.h"
+#include "../src/StudentManager.h"
+#include "../src/CampusCompass.h"
+#include "../src/SearchWorkspace.h"
+#include "../src/CommandTokens.h"
+#include "../src/CommandBatch.h"
+#include "../src/CsvRows.h"
+#include "../src/Snapshot.h"
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <thread>
+
+TEST_CASE("graph csr keeps edge state across rebuilds", "[graph]") {
+    Graph g;
+    g.addLocation(10, "A");
+    g.addLocation(20, "B");
+    g.addLocation(30, "C");
+    g.addEdge(10, 20, 4);
+
+    g.toggleEdge(20, 10);
+    REQUIRE(g.edgeStatus(10, 20) == "closed");
+    REQUIRE(g.edgeStatus(20, 10) == "closed");
+
+    // adding an edge forces the adjacency to be rebuilt
+    g.addEdge(20, 30, 1);
+    REQUIRE(g.edgeStatus(10, 20) == "closed");
+    REQUIRE(g.isConnected(10, 30) == false);
+    REQUIRE(g.shortestPath(20, 30) == 1);
+
+    g.toggleEdge(10, 20);
+    REQUIRE(g.shortestPath(10, 30) == 5);
+}
+
+TEST_CASE("graph location without edges is not part of the graph", "[graph]") {
+    Graph g;
+    g.addLocation(1, "A");
+    g.addLocation(2, "B");
+    g.addEdge(1, 2, 3);
+    g.addLocation(3, "C");
+
+    REQUIRE(g.hasLocation(3) == true);
+    REQUIRE(g.shortestPath(3, 3) == -1);
+    REQUIRE(g.isConnected(3, 3) == false);
+    REQUIRE(g.shortestPath(1, 1) == 0);
+}
+
+TEST_CASE("graph repeated queries do not see stale distances", "[graph]") {
+    Graph g;
+    for (int i = 1; i <= 5; i++) g.addLocation(i, "L");
+    g.addEdge(1, 2, 1);
+    g.addEdge(2, 3, 1);
+    g.addEdge(3, 4, 1);
+    g.addLocation(6, "island");
+    g.addEdge(5, 6, 1);
+
+    REQUIRE(g.shortestPath(1, 4) == 3);
+    // 4 was reached by the previous query but must not be by this one
+    REQUIRE(g.shortestPath(5, 4) == -1);
+    REQUIRE(g.shortestPath(4, 1) == 3);
+
+    std::vector<int> route;
+    REQUIRE(g.shortestPathWithRoute(4, 2, route) == 2);
+    REQUIRE(route == std::vector<int>{4, 3, 2});
+}
+
+TEST_CASE("graph queries stop allocating once warmed up", "[graph]") {
+    Graph g;
+    for (int i = 1; i <= 6; i++) g.addLocation(i, "L");
+    g.addEdge(1, 2, 2);
+    g.addEdge(2, 3, 2);
+    g.addEdge(3, 4, 1);
+    g.addEdge(4, 5, 3);
+    g.addEdge(1, 5, 9);
+    g.addEdge(5, 6, 1);
+
+    std::unordered_set<int> zone = {1, 2, 3, 4};
+    std::vector<int> route;
+    route.reserve(8);
+    auto runQueries = [&]() {
+        REQUIRE(g.isConnected(1, 6));
+        REQUIRE(g.shortestPath(1, 6) == 9);
+        REQUIRE(g.shortestPathWithRoute(6, 1, route) == 9);
+        REQUIRE(g.mstCost(zone) == 5);
+    };
+
+    runQueries();
+    size_t warm = SearchWorkspace::allocationCount();
+    for (int i = 0; i < 100; i++) runQueries();
+    REQUIRE(SearchWorkspace::allocationCount() == warm);
+}
+
+TEST_CASE("graph shortestpaths matches per-target queries", "[graph]") {
+    Graph g;
+    for (int i = 1; i <= 6; i++) g.addLocation(i, "L");
+    g.addEdge(1, 2, 4);
+    g.addEdge(1, 3, 1);
+    g.addEdge(3, 2, 1);
+    g.addEdge(2, 4, 5);
+    g.addEdge(5, 6, 2);
+
+    std::vector<int> targets = {2, 4, 3, 2, 6, 99, 1};
+    std::vector<int> distances;
+    g.shortestPaths(1, targets, distances);
+
+    REQUIRE(distances.size() == targets.size());
+    for (size_t i = 0; i < targets.size(); i++) {
+        REQUIRE(distances[i] == g.shortestPath(1, targets[i]));
+    }
+    REQUIRE(distances[1] == 7);
+    REQUIRE(distances[4] == -1);
+}
+
+TEST_CASE("graph shortestpathtree routes match shortestpathwithroute", "[graph]") {
+    Graph g;
+    for (int i = 1; i <= 7; i++) g.addLocation(i, "L");
+    g.addEdge(1, 2, 1);
+    g.addEdge(2, 3, 1);
+    g.addEdge(1, 4, 1);
+    g.addEdge(4, 3, 1);   // tie with 1-2-3
+    g.addEdge(3, 5, 2);
+    g.addEdge(4, 6, 3);
+
+    std::vector<int> targets = {5, 6, 3, 7};
+    ShortestPathTree tree;
+    g.shortestPathTree(1, targets, tree);
+
+    REQUIRE(tree.size() == targets.size());
+    std::vector<int> expected;
+    std::vector<int> got;
+    for (size_t i = 0; i < targets.size(); i++) {
+        REQUIRE(tree.distance(i) == g.shortestPathWithRoute(1, targets[i], expected));
+        tree.route(i, got);
+        REQUIRE(got == expected);
+    }
+
+    // 1, 2, 3, 5 for the first route plus 4, 6 for the second
+    std::vector<int> zone = tree.vertices();
+    std::sort(zone.begin(), zone.end());
+    REQUIRE(zone == std::vector<int>{1, 2, 3, 4, 5, 6});
+    REQUIRE(g.mstCost(tree.vertices()) == 8);
+}
+
+TEST_CASE("graph distance cache follows edge toggles", "[graph]") {
+    Graph g;
+    for (int i = 1; i <= 4; i++) g.addLocation(i, "L");
+    g.addEdge(1, 2, 2);
+    g.addEdge(2, 3, 2);
+    g.addEdge(1, 3, 5);
+
+    g.setDistanceCacheBudget(1 << 20);
+    REQUIRE(g.distanceCacheActive());
+    REQUIRE(g.shortestPath(1, 3) == 4);
+    REQUIRE(g.shortestPath(3, 1) == 4);
+    REQUIRE(g.shortestPath(1, 4) == -1);
+
+    g.toggleEdge(2, 3);
+    REQUIRE(g.shortestPath(1, 3) == 5);
+    REQUIRE(g.shortestPath(3, 2) == 7);
+
+    // a new edge grows the graph and the cache with it
+    g.addEdge(3, 4, 1);
+    REQUIRE(g.shortestPath(4, 1) == 6);
+
+    // too small for the 4 x 4 matrix, so queries fall back to dijkstra
+    g.setDistanceCacheBudget(4 * 4 * sizeof(int) - 1);
+    REQUIRE_FALSE(g.distanceCacheActive());
+    REQUIRE(g.shortestPath(4, 1) == 6);
+}
+
+TEST_CASE("graph distance cache repairs match dijkstra under random toggles", "[graph]") {
+    std::mt19937 rng(7);
+    for (int round = 0; round < 20; round++) {
+        Graph cached;
+        Graph plain;
+        int n = 6 + round % 10;
+        std::vector<std::pair<int,int>> pairs;
+        for (int e = 0; e < n * 2; e++) {
+            int a = rng() % n;
+            int b = rng() % n;
+            int w = 1 + rng() % 5;
+            cached.addEdge(a, b, w);
+            plain.addEdge(a, b, w);
+            pairs.push_back({a, b});
+        }
+        cached.setDistanceCacheBudget(1 << 20);
+
+        for (int step = 0; step < 30; step++) {
+            for (int s = 0; s < n; s++) {
+                for (int t = 0; t < n; t++) {
+                    REQUIRE(cached.shortestPath(s, t) == plain.shortestPath(s, t));
+                }
+            }
+            auto [a, b] = pairs[rng() % pairs.size()];
+            cached.toggleEdge(a, b);
+            plain.toggleEdge(a, b);
+        }
+    }
+}
+
+TEST_CASE("graph component index agrees with path search under random toggles", "[graph]") {
+    std::mt19937 rng(11);
+    for (int round = 0; round < 20; round++) {
+        Graph g;
+        int n = 5 + round % 12;
+        std::vector<std::pair<int,int>> pairs;
+        for (int e = 0; e < n + round % 7; e++) {
+            int a = rng() % n;
+            int b = rng() % n;
+            g.addEdge(a, b, 1 + rng() % 3);
+            pairs.push_back({a, b});
+        }
+
+        for (int step = 0; step < 60; step++) {
+            // toggle a few edges between queries so closures and reopenings
+            // stack up on dirty components
+            for (int k = rng() % 3; k >= 0; k--) {
+                auto [a, b] = pairs[rng() % pairs.size()];
+                g.toggleEdge(a, b);
+            }
+            int a = rng() % n;
+            int b = rng() % n;
+            // dijkstra walks the open edges independently of the index
+            REQUIRE(g.isConnected(a, b) == (g.shortestPath(a, b) >= 0));
+        }
+    }
+}
+
+TEST_CASE("graph toggle and status share one flag per edge", "[graph]") {
+    Graph g;
+    g.addEdge(1, 2, 5);
+    g.addEdge(2, 1, 1);   // parallel edge, never addressed by toggles
+
+    g.toggleEdge(2, 1);
+    REQUIRE(g.edgeStatus(1, 2) == "closed");
+    REQUIRE(g.edgeStatus(2, 1) == "closed");
+    // the parallel edge is still open
+    REQUIRE(g.shortestPath(1, 2) == 1);
+    REQUIRE(g.isConnected(2, 1));
+
+    g.toggleEdge(1, 2);
+    REQUIRE(g.edgeStatus(2, 1) == "open");
+    REQUIRE(g.edgeStatus(1, 3) == "DNE");
+}
+
+TEST_CASE("graph batched toggles match one-at-a-time toggles", "[graph]") {
+    std::mt19937 rng(23);
+    for (int round = 0; round < 20; round++) {
+        Graph batched;
+        Graph single;
+        int n = 6 + round % 9;
+        std::vector<std::pair<int,int>> pairs;
+        for (int e = 0; e < n * 2; e++) {
+            int a = rng() % n;
+            int b = rng() % n;
+            int w = 1 + rng() % 4;
+            batched.addEdge(a, b, w);
+            single.addEdge(a, b, w);
+            pairs.push_back({a, b});
+        }
+        batched.setDistanceCacheBudget(1 << 20);
+
+        for (int step = 0; step < 20; step++) {
+            for (int s = 0; s < n; s++) {
+                for (int t = 0; t < n; t++) {
+                    REQUIRE(batched.shortestPath(s, t) == single.shortestPath(s, t));
+                    REQUIRE(batched.isConnected(s, t) == single.isConnected(s, t));
+                    REQUIRE(batched.edgeStatus(s, t) == single.edgeStatus(s, t));
+                }
+            }
+            // batches mix closures, reopenings, repeats and unknown pairs
+            std::vector<std::pair<int,int>> batch;
+            for (int k = rng() % 6; k >= 0; k--) {
+                auto [a, b] = pairs[rng() % pairs.size()];
+                if (rng() % 2) std::swap(a, b);
+                batch.push_back({a, b});
+                if (rng() % 4 == 0) batch.push_back({a, b});
+            }
+            batch.push_back({n + 1, 0});
+            batched.toggleEdges(batch);
+            for (auto [a, b] : batch) single.toggleEdge(a, b);
+        }
+    }
+}
+
+TEST_CASE("graph landmark search matches dijkstra under random toggles", "[graph]") {
+    std::mt19937 rng(31);
+    for (int round = 0; round < 20; round++) {
+        Graph alt;
+        Graph plain;
+        int n = 8 + round % 13;
+        std::vector<std::pair<int,int>> pairs;
+        for (int e = 0; e < n * 2; e++) {
+            int a = rng() % n;
+            int b = rng() % n;
+            int w = rng() % 6;   // zero weights included
+            alt.addEdge(a, b, w);
+            plain.addEdge(a, b, w);
+            pairs.push_back({a, b});
+        }
+        alt.setPathSearch(PathSearch::Landmarks);
+        alt.setLandmarkCount(1 + round % 4);
+
+        for (int step = 0; step < 25; step++) {
+            for (int s = 0; s < n; s++) {
+                for (int t = 0; t < n; t++) {
+                    REQUIRE(alt.shortestPath(s, t) == plain.shortestPath(s, t));
+                }
+            }
+            auto [a, b] = pairs[rng() % pairs.size()];
+            alt.toggleEdge(a, b);
+            plain.toggleEdge(a, b);
+        }
+    }
+}
+
+TEST_CASE("graph bidirectional search matches dijkstra on random graphs", "[graph]") {
+    std::mt19937 rng(47);
+    for (int round = 0; round < 30; round++) {
+        Graph bidi;
+        Graph plain;
+        int n = 5 + round % 16;
+        std::vector<std::pair<int,int>> pairs;
+        for (int e = 0; e < n + n * (round % 3); e++) {
+            int a = rng() % n;
+            int b = rng() % n;
+            int w = rng() % 8;
+            bidi.addEdge(a, b, w);
+            plain.addEdge(a, b, w);
+            pairs.push_back({a, b});
+        }
+        bidi.setPathSearch(PathSearch::Bidirectional);
+
+        for (int step = 0; step < 10; step++) {
+            for (int s = 0; s < n; s++) {
+                for (int t = 0; t < n; t++) {
+                    REQUIRE(bidi.shortestPath(s, t) == plain.shortestPath(s, t));
+                }
+            }
+            auto [a, b] = pairs[rng() % pairs.size()];
+            bidi.toggleEdge(a, b);
+            plain.toggleEdge(a, b);
+        }
+    }
+}
+
+TEST_CASE("graph contraction hierarchy matches dijkstra under toggles and growth", "[graph]") {
+    std::mt19937 rng(53);
+    for (int round = 0; round < 25; round++) {
+        Graph ch;
+        Graph plain;
+        int n = 6 + round % 15;
+        std::vector<std::pair<int,int>> pairs;
+        auto add = [&](int a, int b, int w) {
+            ch.addEdge(a, b, w);
+            plain.addEdge(a, b, w);
+            pairs.push_back({a, b});
+        };
+        for (int e = 0; e < n + n * (round % 3); e++) add(rng() % n, rng() % n, rng() % 7);
+        ch.setPathSearch(PathSearch::ContractionHierarchy);
+
+        for (int step = 0; step < 15; step++) {
+            for (int s = 0; s < n + 1; s++) {
+                for (int t = 0; t < n + 1; t++) {
+                    REQUIRE(ch.shortestPath(s, t) == plain.shortestPath(s, t));
+                }
+            }
+            // mostly toggles, which only redo the shortcuts above the edge;
+            // now and then a new edge, which forces a fresh ordering
+            if (step % 5 == 4) {
+                add(rng() % (n + 1), rng() % (n + 1), rng() % 7);
+            } else {
+                auto [a, b] = pairs[rng() % pairs.size()];
+                ch.toggleEdge(a, b);
+                plain.toggleEdge(a, b);
+            }
+        }
+    }
+}
+
+TEST_CASE("graph contraction hierarchy keeps up with toggles on a grid with shortcuts", "[graph]") {
+    // large enough for several levels of separators, with long edges
+    // cutting across them and zero weights making ties
+    std::mt19937 rng(61);
+    for (int round = 0; round < 4; round++) {
+        Graph ch;
+        Graph plain;
+        int side = 8 + round * 4;
+        int n = side * side;
+        std::vector<std::pair<int,int>> pairs;
+        auto add = [&](int a, int b, int w) {
+            ch.addEdge(a, b, w);
+            plain.addEdge(a, b, w);
+            pairs.push_back({a, b});
+        };
+        for (int r = 0; r < side; r++) {
+            for (int c = 0; c < side; c++) {
+                int id = r * side + c;
+                if (c + 1 < side) add(id, id + 1, rng() % 6);
+                if (r + 1 < side) add(id, id + side, rng() % 6);
+            }
+        }
+        for (int i = 0; i < side; i++) add(rng() % n, rng() % n, 5 + rng() % 20);
+        ch.setPathSearch(PathSearch::ContractionHierarchy);
+
+        for (int step = 0; step < 30; step++) {
+            for (int q = 0; q < 200; q++) {
+                int s = rng() % n;
+                int t = rng() % n;
+                REQUIRE(ch.shortestPath(s, t) == plain.shortestPath(s, t));
+            }
+            std::vector<std::pair<int,int>> batch;
+            for (int k = 0; k < 1 + step % 4; k++) batch.push_back(pairs[rng() % pairs.size()]);
+            ch.toggleEdges(batch);
+            plain.toggleEdges(batch);
+        }
+    }
+}
+
+TEST_CASE("graph bucket queue gives the same answers as the binary heap", "[graph]") {
+    std::mt19937 rng(59);
+    for (int round = 0; round < 30; round++) {
+        Graph buckets;
+        Graph heap;
+        heap.setBucketQueueLimit(0);
+        buckets.setBucketQueueLimit(round % 2 ? 255 : 4);  // 4: some graphs fall back
+        int n = 5 + round % 14;
+        std::vector<std::pair<int,int>> pairs;
+        for (int e = 0; e < n * 2; e++) {
+            int a = rng() % n;
+            int b = rng() % n;
+            int w = rng() % (round % 3 ? 6 : 40);
+            buckets.addEdge(a, b, w);
+            heap.addEdge(a, b, w);
+            pairs.push_back({a, b});
+        }
+
+        for (int step = 0; step < 8; step++) {
+            std::vector<int> all;
+            for (int v = 0; v < n; v++) all.push_back(v);
+            for (int s = 0; s < n; s++) {
+                std::vector<int> got, want;
+                buckets.shortestPaths(s, all, got);
+                heap.shortestPaths(s, all, want);
+                REQUIRE(got == want);
+                for (int t = 0; t < n; t++) {
+                    std::vector<int> gotRoute, wantRoute;
+                    REQUIRE(buckets.shortestPath(s, t) == heap.shortestPath(s, t));
+                    REQUIRE(buckets.shortestPathWithRoute(s, t, gotRoute) == heap.shortestPathWithRoute(s, t, wantRoute));
+                    REQUIRE(gotRoute == wantRoute);
+                }
+            }
+            std::vector<int> subset;
+            for (int v = 0; v < n; v++) {
+                if (rng() % 2) subset.push_back(v);
+            }
+            REQUIRE(buckets.mstCost(subset) == heap.mstCost(subset));
+
+            auto [a, b] = pairs[rng() % pairs.size()];
+            buckets.toggleEdge(a, b);
+            heap.toggleEdge(a, b);
+        }
+    }
+}
+
+TEST_CASE("search workspace heap keeps one entry per vertex", "[graph]") {
+    std::mt19937 rng(61);
+    SearchWorkspace ws;
+    auto later = std::greater<SearchWorkspace::HeapItem>();
+    for (int round = 0; round < 20; round++) {
+        int n = 1 + round * 7;
+        ws.begin(n);
+        std::vector<int> best(n, -1);
+        for (int i = 0; i < n * 6; i++) {
+            int v = rng() % n;
+            int key = rng() % 100;
+            ws.pushHeap({key, v}, later);
+            if (best[v] < 0 || key < best[v]) best[v] = key;
+            REQUIRE(ws.heap.size() <= (size_t)n);
+        }
+
+        // everything comes out once, at its smallest key, in key order
+        std::vector<SearchWorkspace::HeapItem> popped;
+        while (!ws.heapEmpty()) popped.push_back(ws.popHeap(later));
+        REQUIRE(std::is_sorted(popped.begin(), popped.end()));
+        for (auto [key, v] : popped) REQUIRE(best[v] == key);
+        REQUIRE(popped.size() == (size_t)(n - std::count(best.begin(), best.end(), -1)));
+    }
+}
+
+TEST_CASE("graph mstCost agrees with a reference for small and large subsets", "[graph]") {
+    // subsets below an eighth of the graph go through prim, larger ones
+    // through kruskal; both must match a plain kruskal over the edge list
+    struct Edge { int a, b, w; bool open; };
+    std::mt19937 rng(67);
+    for (int round = 0; round < 25; round++) {
+        Graph g;
+        std::vector<Edge> list;
+        int n = 10 + round * 3;
+        for (int e = 0; e < n * 2; e++) {
+            Edge edge{(int)(rng() % n), (int)(rng() % n), (int)(rng() % 9), true};
+            g.addEdge(edge.a, edge.b, edge.w);
+            list.push_back(edge);
+        }
+
+        for (int step = 0; step < 20; step++) {
+            std::vector<int> subset;
+            size_t want = 1 + rng() % n;
+            for (int v = 0; v < n && subset.size() < want; v++) {
+                if (rng() % n < want) subset.push_back(v);
+            }
+            if (subset.empty()) subset.push_back(0);
+
+            std::vector<Edge> sorted = list;
+            std::stable_sort(sorted.begin(), sorted.end(), [](const Edge &x, const Edge &y) { return x.w < y.w; });
+            std::vector<int> parent(n);
+            for (int v = 0; v < n; v++) parent[v] = v;
+            std::function<int(int)> find = [&](int v) { return parent[v] == v ? v : parent[v] = find(parent[v]); };
+            auto inSubset = [&](int v) { return std::find(subset.begin(), subset.end(), v) != subset.end(); };
+            int total = 0;
+            size_t joined = 1;
+            for (const auto &e : sorted) {
+                if (!e.open || !inSubset(e.a) || !inSubset(e.b) || find(e.a) == find(e.b)) continue;
+                parent[find(e.a)] = find(e.b);
+                total += e.w;
+                joined++;
+            }
+            REQUIRE(g.mstCost(subset) == (joined == subset.size() ? total : -1));
+
+            // toggleEdge acts on the first edge added between the pair
+            const Edge pick = list[rng() % list.size()];
+            g.toggleEdge(pick.a, pick.b);
+            for (auto &e : list) {
+                if ((e.a == pick.a && e.b == pick.b) || (e.a == pick.b && e.b == pick.a)) {
+                    e.open = !e.open;
+                    break;
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("campuscompass memoizes zone costs until an edge inside the zone changes", "[integration]") {
+    std::ostringstream oss;
+    CampusCompass c(oss);
+    REQUIRE(c.ParseCSV("../data/edges.csv", "../data/classes.csv"));
+
+    c.ParseCommand("insert \"Ada\" 10000001 1 2 COP3502 COP3504");
+    c.ParseCommand("insert \"Bea\" 10000002 1 2 COP3504 COP3502");
+    c.ParseCommand("printStudentZone 10000001");
+    c.ParseCommand("printStudentZone 10000002");
+    c.flushOutput();
+    // same residence and classes, so the second zone is a hit
+    REQUIRE(c.zoneCacheMisses() == 1);
+    REQUIRE(c.zoneCacheHits() == 1);
+    std::string out = oss.str();
+    std::string first = out.substr(out.find("Ada: ") + 5);
+    std::string second = out.substr(out.find("Bea: ") + 5);
+    REQUIRE(first.substr(0, first.find('\n')) == second.substr(0, second.find('\n')));
+
+    // the zone is {1, 3, 4, 6, 13, 14, 15, 23}: an edge leaving it does
+    // not matter, one inside it does
+    c.ParseCommand("toggleEdgesClosure 1 1 50");
+    c.ParseCommand("printStudentZone 10000001");
+    c.flushOutput();
+    REQUIRE(c.zoneCacheMisses() == 1);
+    REQUIRE(c.zoneCacheHits() == 2);
+
+    c.ParseCommand("toggleEdgesClosure 1 14 23");
+    c.ParseCommand("printStudentZone 10000001");
+    c.flushOutput();
+    REQUIRE(c.zoneCacheMisses() == 2);
+    REQUIRE(c.zoneCacheHits() == 2);
+}
+
+TEST_CASE("graph distance table columns follow toggles and new edges", "[graph]") {
+    std::mt19937 rng(71);
+    for (int round = 0; round < 20; round++) {
+        Graph tabled;
+        Graph plain;
+        int n = 6 + round % 12;
+        std::vector<std::pair<int,int>> pairs;
+        auto add = [&](int a, int b, int w) {
+            tabled.addEdge(a, b, w);
+            plain.addEdge(a, b, w);
+            pairs.push_back({a, b});
+        };
+        for (int e = 0; e < n * 2; e++) add(rng() % n, rng() % n, rng() % 9);
+        // a source beyond the current locations starts as an empty column
+        std::vector<int> sources = {0, (int)(rng() % n), n + 1};
+        tabled.setDistanceTableSources(sources);
+
+        for (int step = 0; step < 15; step++) {
+            std::vector<int> all;
+            for (int v = 0; v < n + 2; v++) all.push_back(v);
+            for (int s = 0; s < n + 2; s++) {
+                std::vector<int> got, want;
+                tabled.shortestPaths(s, sources, got);
+                plain.shortestPaths(s, sources, want);
+                REQUIRE(got == want);
+                for (int t : sources) {
+                    REQUIRE(tabled.shortestPath(s, t) == plain.shortestPath(s, t));
+                    REQUIRE(tabled.shortestPath(t, s) == plain.shortestPath(t, s));
+                }
+            }
+            if (step % 4 == 3) {
+                add(rng() % (n + 2), rng() % (n + 2), rng() % 9);
+            } else {
+                auto [a, b] = pairs[rng() % pairs.size()];
+                tabled.toggleEdge(a, b);
+                plain.toggleEdge(a, b);
+            }
+        }
+    }
+}
+
+TEST_CASE("graph distance table columns are computed when the sources are set", "[graph]") {
+    Graph g;
+    g.addEdge(1, 2, 4);
+    g.addEdge(2, 3, 7);
+    g.addEdge(1, 3, 12);
+    REQUIRE(g.distanceTableReady());
+    g.setDistanceTableSources({1, 3});
+    REQUIRE(g.distanceTableReady());
+
+    // a toggle leaves the columns to their next read
+    g.toggleEdge(2, 3);
+    REQUIRE_FALSE(g.distanceTableReady());
+    REQUIRE(g.shortestPath(2, 3) == 16);
+    REQUIRE(g.shortestPath(2, 1) == 4);
+    REQUIRE(g.distanceTableReady());
+
+    // a snapshot without the columns computes them as it loads
+    SnapshotWriter out;
+    g.writeSnapshot(out, false);
+    Graph copy;
+    SnapshotReader in(out.data());
+    REQUIRE(copy.readSnapshot(in));
+    REQUIRE(copy.distanceTableReady());
+    REQUIRE(copy.shortestPath(2, 3) == 16);
+}
+
+TEST_CASE("graph const queries from several threads agree with one thread", "[graph]") {
+    // every graph starts with nothing built, so the threads race to build
+    // the adjacency arrays, labels, landmarks, hierarchy, cache and table
+    const int side = 12;
+    const int n = side * side;
+    std::mt19937 rng(83);
+    std::vector<std::array<int,3>> edges;
+    for (int r = 0; r < side; r++) {
+        for (int c = 0; c < side; c++) {
+            int id = r * side + c;
+            if (c + 1 < side) edges.push_back({id, id + 1, (int)(rng() % 9)});
+            if (r + 1 < side) edges.push_back({id, id + side, (int)(rng() % 9)});
+        }
+    }
+    for (int i = 0; i < side; i++) edges.push_back({(int)(rng() % n), (int)(rng() % n), (int)(5 + rng() % 20)});
+    auto build = [&](Graph &g) {
+        for (auto [a, b, w] : edges) g.addEdge(a, b, w);
+        for (int i = 0; i < side; i++) g.toggleEdge(edges[i * 7].at(0), edges[i * 7].at(1));
+    };
+
+    Graph plain;
+    build(plain);
+    std::vector<std::pair<int,int>> queries;
+    std::vector<int> want;
+    for (int q = 0; q < 300; q++) {
+        queries.push_back({(int)(rng() % n), (int)(rng() % n)});
+        want.push_back(plain.shortestPath(queries.back().first, queries.back().second));
+    }
+    std::vector<int> zone = {0, 1, 2, side, side + 1, side + 2};
+    int zoneCost = plain.mstCost(zone);
+
+    for (int mode = 0; mode < 5; mode++) {
+        Graph g;
+        build(g);
+        if (mode == 1) g.setPathSearch(PathSearch::Landmarks);
+        if (mode == 2) g.setPathSearch(PathSearch::ContractionHierarchy);
+        if (mode == 3) g.setDistanceCacheBudget(size_t(1) << 20);
+        if (mode == 4) g.setDistanceTableSources({0, n - 1});
+
+        std::vector<std::vector<int>> got(4);
+        std::vector<char> connected(4), zoneOk(4);
+        std::vector<std::thread> threads;
+        for (int k = 0; k < 4; k++) {
+            threads.emplace_back([&, k] {
+                for (size_t q = 0; q < queries.size(); q++) {
+                    auto [s, t] = queries[(q + k * 75) % queries.size()];
+                    got[k].push_back(g.shortestPath(s, t));
+                }
+                connected[k] = g.isConnected(0, n - 1) == plain.isConnected(0, n - 1);
+                zoneOk[k] = g.mstCost(zone) == zoneCost;
+            });
+        }
+        for (auto &thread : threads) thread.join();
+        for (int k = 0; k < 4; k++) {
+            for (size_t q = 0; q < queries.size(); q++) {
+                REQUIRE(got[k][q] == want[(q + k * 75) % queries.size()]);
+            }
+            REQUIRE(connected[k]);
+            REQUIRE(zoneOk[k]);
+        }
+    }
+}
+
+TEST_CASE("campuscompass memoizes schedule travel times per graph version", "[integration]") {
+    std::ostringstream oss;
+    CampusCompass c(oss);
+    REQUIRE(c.ParseCSV("../data/edges.csv", "../data/classes.csv"));
+
+    c.ParseCommand("insert \"Ada\" 10000001 1 2 COP3502 COP3504");
+    c.ParseCommand("insert \"Bea\" 10000002 2 2 COP3504 COP3502");
+    c.ParseCommand("verifySchedule 10000001");
+    c.ParseCommand("verifySchedule 10000002");
+    c.flushOutput();
+    // both schedules need the same pair of class locations
+    REQUIRE(c.travelCacheMisses() == 1);
+    REQUIRE(c.travelCacheHits() == 1);
+    std::string out = oss.str();
+    auto lineAfter = [&](const std::string &marker) {
+        size_t from = out.find(marker) + marker.size();
+        return out.substr(from, out.find('\n', from) - from);
+    };
+    REQUIRE(lineAfter("Ada:\n").rfind("COP3502 - COP3504 ", 0) == 0);
+    REQUIRE(lineAfter("Ada:\n") == lineAfter("Bea:\n"));
+
+    c.ParseCommand("toggleEdgesClosure 1 1 2");
+    c.ParseCommand("verifySchedule 10000001");
+    c.flushOutput();
+    REQUIRE(c.travelCacheMisses() == 2);
+}
+
+TEST_CASE("graph version tracks changes and toggle history", "[graph]") {
+    Graph g;
+    g.addLocation(1, "A");
+    uint64_t v0 = g.version();
+    g.addLocation(1, "A");  // nothing new
+    REQUIRE(g.version() == v0);
+    g.addEdge(1, 2, 3);
+    g.addEdge(2, 3, 4);
+    g.addEdge(3, 4, 5);
+    uint64_t built = g.version();
+    REQUIRE(built > v0);
+    REQUIRE(g.edgeVersion(2, 1) == g.edgeVersion(1, 2));
+    REQUIRE(g.edgeVersion(1, 3) == 0);
+
+    std::vector<std::pair<int,int>> pairs;
+    REQUIRE(!g.toggledSince(v0, pairs));  // edges were added since
+    REQUIRE(g.toggledSince(built, pairs));
+    REQUIRE(pairs.empty());
+
+    g.toggleEdge(1, 2);
+    g.toggleEdge(3, 4);
+    g.toggleEdge(1, 2);
+    REQUIRE(g.edgeVersion(1, 2) == g.version());
+    REQUIRE(g.toggledSince(built, pairs));
+    std::sort(pairs.begin(), pairs.end());
+    REQUIRE(pairs == std::vector<std::pair<int,int>>{{1, 2}, {3, 4}});
+
+    // a long enough history is dropped instead of kept forever
+    for (int i = 0; i < 200; i++) g.toggleEdge(2, 3);
+    REQUIRE(!g.toggledSince(built, pairs));
+    uint64_t recent = g.version();
+    g.toggleEdge(2, 3);
+    REQUIRE(g.toggledSince(recent, pairs));
+    REQUIRE(pairs == std::vector<std::pair<int,int>>{{2, 3}});
+}
+
+TEST_CASE("command tokens read like a stringstream", "[parser]") {
+    // zero-initialised targets, so a read the stream skips and one that
+    // fails both show up as 0
+    const std::vector<std::string> pieces = {
+        "12", "+7", "-3", "0", "007", "-0", "+", "-", "+-4", "--4", "99999999999", "-99999999999",
+        "2147483647", "-2147483648", "12abc", "4.5", "x", "COP3502", "\t", "\r", "  ", "\"", "Ann Lee",
+    };
+    std::mt19937 rng(73);
+    for (int round = 0; round < 3000; round++) {
+        std::string line;
+        int count = rng() % 6;
+        for (int i = 0; i < count; i++) {
+            line += pieces[rng() % pieces.size()];
+            if (rng() % 3) line += rng() % 4 ? " " : "\t";
+        }
+
+        std::stringstream ss(line);
+        CommandTokens in(line);
+        if (rng() % 4 == 0) {
+            std::string skipped, expected;
+            std::getline(ss, skipped, '"');
+            std::getline(ss, expected, '"');
+            REQUIRE(std::string(in.quoted()) == expected);
+        }
+        for (int read = 0; read < 4; read++) {
+            if (rng() % 2) {
+                std::string expected;
+                ss >> expected;
+                REQUIRE(std::string(in.word()) == expected);
+            } else {
+                int expected = 0;
+                ss >> expected;
+                REQUIRE(in.number() == expected);
+            }
+            REQUIRE(in.failed() == ss.fail());
+        }
+    }
+}
+
+TEST_CASE("campuscompass output reaches its stream only when flushed", "[integration]") {
+    std::ostringstream oss;
+    {
+        CampusCompass c(oss);
+        REQUIRE(c.ParseCSV("../data/edges.csv", "../data/classes.csv"));
+        c.ParseCommand("isConnected 1 2");
+        c.ParseCommand("checkEdgeStatus 1 2");
+        REQUIRE(oss.str().empty());
+        c.flushOutput();
+        REQUIRE(oss.str() == "successful\nopen\n");
+        c.ParseCommand("removeClass COP3502");
+    }
+    // the rest is written when the CampusCompass goes away
+    REQUIRE(oss.str() == "successful\nopen\n0\n");
+}
+
+TEST_CASE("command batch runs lines split across chunks like one buffer", "[integration]") {
+    std::string log = "3\nisConnected 1 2\r\ncheckEdgeStatus 1 2\n\ntoggleEdgesClosure 1 1 2\nisConnected 1 2\n";
+    std::ostringstream whole;
+    {
+        CampusCompass c(whole);
+        REQUIRE(c.ParseCSV("../data/edges.csv", "../data/classes.csv"));
+        CommandBatch batch(c);
+        batch.feed(log, true);
+        // the count line caps the run at three commands, the blank one included
+        REQUIRE(batch.commands() == 3);
+        REQUIRE(batch.done());
+    }
+    REQUIRE(whole.str() == "successful\nopen\nunsuccessful\n");
+
+    for (size_t chunk = 1; chunk < log.size(); chunk += 3) {
+        std::ostringstream pieces;
+        {
+            CampusCompass c(pieces);
+            REQUIRE(c.ParseCSV("../data/edges.csv", "../data/classes.csv"));
+            CommandBatch batch(c);
+            std::string pending;
+            for (size_t at = 0; at < log.size(); at += chunk) {
+                pending += log.substr(at, chunk);
+                pending.erase(0, batch.feed(pending, at + chunk >= log.size()));
+            }
+        }
+        REQUIRE(pieces.str() == whole.str());
+    }
+
+    // without a count line every line runs, the unterminated last one too
+    std::ostringstream open;
+    {
+        CampusCompass c(open);
+        REQUIRE(c.ParseCSV("../data/edges.csv", "../data/classes.csv"));
+        CommandBatch batch(c);
+        batch.feed("checkEdgeStatus 1 2\ncheckEdgeStatus 1 999", true);
+        REQUIRE(batch.commands() == 2);
+    }
+    REQUIRE(open.str() == "open\nDNE\n");
+}
+
+TEST_CASE("csv rows split fields and read numbers in place", "[parser]") {
+    std::string text = "a,b\r\n\n 7,Hume Hall,+3,09:35\r\n-2,,x,10:5\nlast";
+    REQUIRE(CsvRows::countLines(text) == 5);
+    CsvRows rows(text);
+    REQUIRE(rows.nextRow());
+    REQUIRE(rows.field() == "a");
+    REQUIRE(rows.field() == "b");
+    // the blank line is skipped and the '\r' dropped
+    REQUIRE(rows.nextRow());
+    REQUIRE(rows.integer() == 7);
+    REQUIRE(rows.field() == "Hume Hall");
+    REQUIRE(rows.integer() == 3);
+    REQUIRE(rows.minutes() == 9 * 60 + 35);
+    REQUIRE_FALSE(rows.failed());
+    REQUIRE(rows.field() == "");
+    REQUIRE(rows.failed());
+    REQUIRE(rows.nextRow());
+    REQUIRE(rows.integer() == -2);
+    REQUIRE(rows.field() == "");
+    REQUIRE(rows.integer() == 0);
+    REQUIRE(rows.failed());
+    REQUIRE(rows.nextRow());
+    REQUIRE(rows.field() == "last");
+    REQUIRE_FALSE(rows.nextRow());
+}
+
+TEST_CASE("csv loader reads crlf files and rejects malformed rows", "[integration]") {
+    {
+        std::ofstream e("loader_edges.csv");
+        e << "LocationID_1,LocationID_2,Name_1,Name_2,Time\r\n1,2,Hume Hall,Graham Hall,3\r\n\r\n2,4,Graham Hall,Rawlings Hall,5";
+        std::ofstream k("loader_classes.csv");
+        k << "ClassCode,LocationID,Start,End\r\nCOP3502,4,09:35,10:25\r\n";
+    }
+    std::ostringstream oss;
+    CampusCompass c(oss);
+    REQUIRE(c.ParseCSV("loader_edges.csv", "loader_classes.csv"));
+    c.ParseCommand("insert \"Ann\" 11112222 1 1 COP3502");
+    c.ParseCommand("printShortestEdges 11112222");
+    c.ParseCommand("checkEdgeStatus 1 4");
+    c.flushOutput();
+    REQUIRE(oss.str() == "successful\nName: Ann\nCOP3502 | Total Time: 8\nDNE\n");
+
+    {
+        std::ofstream e("loader_bad.csv");
+        e << "LocationID_1,LocationID_2,Name_1,Name_2,Time\n1,2,Hume Hall,Graham Hall,3\n2,4,Graham Hall,Rawlings Hall\n";
+    }
+    std::ostringstream retried;
+    CampusCompass bad(retried);
+    REQUIRE_FALSE(bad.ParseCSV("loader_bad.csv", "loader_classes.csv"));
+    REQUIRE_FALSE(bad.ParseCSV("loader_missing.csv", "loader_classes.csv"));
+    REQUIRE_FALSE(bad.ParseCSV("loader_edges.csv", "loader_missing.csv"));
+    // the failed loads left nothing behind, so the edge is not doubled
+    REQUIRE(bad.ParseCSV("loader_edges.csv", "loader_classes.csv"));
+    bad.ParseCommand("toggleEdgesClosure 1 1 2");
+    bad.ParseCommand("isConnected 1 2");
+    bad.flushOutput();
+    REQUIRE(retried.str() == "successful\nunsuccessful\n");
+    std::remove("loader_edges.csv");
+    std::remove("loader_classes.csv");
+    std::remove("loader_bad.csv");
+}
+
+TEST_CASE("campus snapshot loads back to the same answers and goes stale with its csv files", "[integration]") {
+    namespace fs = std::filesystem;
+    fs::copy_file("../data/edges.csv", "snap_edges.csv", fs::copy_options::overwrite_existing);
+    fs::copy_file("../data/classes.csv", "snap_classes.csv", fs::copy_options::overwrite_existing);
+    std::vector<std::string> commands = {
+        "insert \"Ann\" 11112222 1 3 COP3502 COP3503 CDA3101",
+        "insert \"Bo\" 11113333 14 2 COP3502 MAC2311",
+        "printShortestEdges 11112222", "printStudentZone 11112222", "verifySchedule 11112222",
+        "toggleEdgesClosure 2 1 2 14 23", "checkEdgeStatus 1 2", "isConnected 1 50",
+        "printShortestEdges 11113333", "printStudentZone 11113333", "verifySchedule 11113333",
+    };
+    auto run = [&](CampusCompass &c) {
+        for (const auto &command : commands) c.ParseCommand(command);
+        c.flushOutput();
+    };
+
+    std::ostringstream fromCsv;
+    {
+        CampusCompass c(fromCsv);
+        REQUIRE(c.LoadCampus("snap_edges.csv", "snap_classes.csv", "campus.snapshot"));
+        REQUIRE(fs::exists("campus.snapshot"));
+        run(c);
+    }
+    std::ostringstream fromSnapshot;
+    {
+        CampusCompass c(fromSnapshot);
+        REQUIRE(c.LoadSnapshot("campus.snapshot", "snap_edges.csv", "snap_classes.csv"));
+        run(c);
+    }
+    REQUIRE(!fromCsv.str().empty());
+    REQUIRE(fromSnapshot.str() == fromCsv.str());
+
+    // only into an empty campus
+    {
+        std::ostringstream oss;
+        CampusCompass c(oss);
+        REQUIRE(c.ParseCSV("snap_edges.csv", "snap_classes.csv"));
+        REQUIRE_FALSE(c.LoadSnapshot("campus.snapshot", "snap_edges.csv", "snap_classes.csv"));
+    }
+
+    // a damaged byte fails the checksum
+    std::string bytes;
+    {
+        std::ifstream in("campus.snapshot", std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    std::string damaged = bytes;
+    damaged[damaged.size() / 2] ^= 1;
+    {
+        std::ofstream out("damaged.snapshot", std::ios::binary);
+        out << damaged;
+    }
+    {
+        std::ostringstream oss;
+        CampusCompass c(oss);
+        REQUIRE_FALSE(c.LoadSnapshot("damaged.snapshot", "snap_edges.csv", "snap_classes.csv"));
+        REQUIRE_FALSE(c.LoadSnapshot("missing.snapshot", "snap_edges.csv", "snap_classes.csv"));
+    }
+
+    // a changed csv file makes the snapshot stale; LoadCampus reads the csv
+    // again and writes a new one
+    {
+        std::ofstream out("snap_classes.csv", std::ios::app);
+        out << "\nXYZ1000,1,08:00,08:50\n";
+    }
+    {
+        std::ostringstream oss;
+        CampusCompass c(oss);
+        REQUIRE_FALSE(c.LoadSnapshot("campus.snapshot", "snap_edges.csv", "snap_classes.csv"));
+    }
+    {
+        std::ostringstream oss;
+        CampusCompass c(oss);
+        REQUIRE(c.LoadCampus("snap_edges.csv", "snap_classes.csv", "campus.snapshot"));
+    }
+    {
+        std::ostringstream oss;
+        CampusCompass c(oss);
+        REQUIRE(c.LoadSnapshot("campus.snapshot", "snap_edges.csv", "snap_classes.csv"));
+        c.ParseCommand("insert \"Cy\" 11114444 1 1 XYZ1000");
+        c.flushOutput();
+        REQUIRE(oss.str() == "successful\n");
+    }
+
+    for (const char *path : {"snap_edges.csv", "snap_classes.csv", "campus.snapshot", "damaged.snapshot"}) {
+        std::remove(path);
+    }
+}
+
+TEST_CASE("campuscompass keeps the zone memo within its capacity", "[integration]") {
+    std::ostringstream capped;
+    std::ostringstream open;
+    CampusCompass small(capped);
+    CampusCompass large(open);
+    REQUIRE(small.ParseCSV("../data/edges.csv", "../data/classes.csv"));
+    REQUIRE(large.ParseCSV("../data/edges.csv", "../data/classes.csv"));
+    small.setZoneCacheCapacity(4);
+
+    std::vector<std::string> commands;
+    for (int r = 1; r <= 12; r++) {
+        std::string id = std::to_string(20000000 + r);
+        commands.push_back("insert \"Ann\" " + id + " " + std::to_string(r) + " 2 COP3502 COP3504");
+        commands.push_back("printStudentZone " + id);
+        if (r % 4 == 0) commands.push_back("toggleEdgesClosure 1 1 2");
+    }
+    for (int round = 0; round < 2; round++) {
+        for (const auto &command : commands) {
+            small.ParseCommand(command);
+            large.ParseCommand(command);
+            REQUIRE(small.zoneCacheSize() <= 4);
+        }
+    }
+    small.flushOutput();
+    large.flushOutput();
+    REQUIRE(capped.str() == open.str());
+    REQUIRE(large.zoneCacheSize() > 4);
+}
+
+TEST_CASE("graph snapshot rejects adjacency arrays that disagree with the edges", "[graph]") {
+    Graph g;
+    g.addEdge(1, 2, 4);
+    g.addEdge(2, 3, 7);
+    g.addEdge(1, 3, 12);
+    g.toggleEdge(2, 3);
+    SnapshotWriter out;
+    g.writeSnapshot(out, false);
+    std::string bytes = out.data();
+
+    {
+        Graph copy;
+        SnapshotReader in(bytes);
+        REQUIRE(copy.readSnapshot(in));
+        REQUIRE(copy.edgeStatus(2, 3) == "closed");
+        REQUIRE(copy.shortestPath(1, 3) == 12);
+        copy.toggleEdge(2, 3);
+        REQUIRE(copy.shortestPath(1, 3) == 11);
+        // only into an empty graph
+        SnapshotReader again(bytes);
+        REQUIRE_FALSE(copy.readSnapshot(again));
+    }
+
+    // the payload ends [reverse, 6 ints][count][arcOf, 3 ints][min][max][no sources]
+    size_t maxAt = bytes.size() - 8 - 4;
+    size_t reverseAt = maxAt - 4 - 3 * 4 - 8 - 6 * 4;
+    auto rejects = [](const std::string &tampered) {
+        Graph copy;
+        SnapshotReader in(tampered);
+        return !copy.readSnapshot(in);
+    };
+
+    std::string swapped = bytes;
+    std::swap_ranges(swapped.begin() + reverseAt, swapped.begin() + reverseAt + 4, swapped.begin() + reverseAt + 4);
+    REQUIRE(swapped != bytes);
+    REQUIRE(rejects(swapped));
+
+    int maxWeight = 0;
+    std::memcpy(&maxWeight, &bytes[maxAt], sizeof(int));
+    REQUIRE(maxWeight == 12);
+    std::string wider = bytes;
+    maxWeight = 300;
+    std::memcpy(&wider[maxAt], &maxWeight, sizeof(int));
+    REQUIRE(rejects(wider));
+}